@@ -990,7 +990,7 @@ module Konpeito
       def ffi_link_flags
         flags = []
 
-        # Add yyjson object files if JSON parse_as is used
+        # Add yyjson object files if JSON parse_as / generate_as is used
         if @uses_json_parse_as
           yyjson_objs = ensure_yyjson_compiled
           flags.concat(yyjson_objs)
@@ -1039,6 +1039,11 @@ module Konpeito
         wrapper_c = File.join(json_stdlib_dir, "yyjson_wrapper.c")
         wrapper_obj = File.join(yyjson_dir, "yyjson_wrapper.o")
 
+        # generate_as runtime (uses the Ruby C API and the shared JSON writer)
+        encoder_c = File.join(json_stdlib_dir, "json_encoder.c")
+        encoder_h = File.join(json_stdlib_dir, "json_writer.h")
+        encoder_obj = File.join(yyjson_dir, "json_encoder.o")
+
         return [] unless File.exist?(yyjson_c) && File.exist?(wrapper_c)
 
         cc = find_llvm_tool("clang") || "cc"
@@ -1055,7 +1060,22 @@ module Konpeito
           system(*cmd) or return []
         end
 
-        [yyjson_obj, wrapper_obj]
+        objs = [yyjson_obj, wrapper_obj]
+
+        # Compile encoder runtime (needs Ruby headers)
+        if File.exist?(encoder_c)
+          encoder_mtime = [File.mtime(encoder_c), File.mtime(encoder_h)].max
+          unless File.exist?(encoder_obj) && File.mtime(encoder_obj) > encoder_mtime
+            cmd = [cc, "-c", "-O3", "-fPIC",
+                   "-I#{RbConfig::CONFIG['rubyhdrdir']}",
+                   "-I#{RbConfig::CONFIG['rubyarchhdrdir']}",
+                   "-I#{yyjson_dir}", "-o", encoder_obj, encoder_c]
+            system(*cmd) or return []
+          end
+          objs << encoder_obj
+        end
+
+        objs
       end
 
       # Compile vendored clay.h implementation if Clay stdlib is used
@@ -1260,10 +1280,12 @@ module Konpeito
       def generate_cfunc_extern_declaration(cfunc_type)
         lines = []
 
-        c_params = cfunc_type.param_types.map do |type|
-          cfunc_type_to_c(type)
-        end.join(", ")
-        c_params = "void" if c_params.empty?
+        c_params = cfunc_type.param_types.flat_map do |type|
+          # Native buffers are passed as (data pointer, length)
+          TypeChecker::Types::CFuncType.buffer_param?(type) ? ["void *", "int64_t"] : [cfunc_type_to_c(type)]
+        end
+        c_params << "int64_t *" if cfunc_type.ptr_len_return?
+        c_params = c_params.empty? ? "void" : c_params.join(", ")
 
         c_return = cfunc_type_to_c(cfunc_type.return_type)
 
@@ -1277,6 +1299,7 @@ module Konpeito
         when :Float then "double"
         when :Integer then "int64_t"
         when :String then "VALUE"
+        when :ByteSlice then "const void *"
         when :Bool then "int"
         when :void then "void"
         else "VALUE"
@@ -664,7 +664,9 @@ module Konpeito
           params: block_def.params,
           body: new_body,
           captures: block_def.captures,
-          is_lambda: block_def.is_lambda
+          is_lambda: block_def.is_lambda,
+          next_label: block_def.next_label,
+          break_label: block_def.break_label
         )
       end
 
@@ -1202,6 +1202,31 @@ module Konpeito
         # konpeito_yyjson_arr_get(yyjson_val *arr, size_t idx)
         @yyjson_arr_get = @mod.functions.add("konpeito_yyjson_arr_get",
           [ptr_type, LLVM::Int64], ptr_type)
+
+        # Single-pass field dispatch
+        # konpeito_yyjson_obj_collect(yyjson_val *obj, uint32_t seed, uint32_t mask,
+        #   const int32_t *slots, const char *names, const uint32_t *offsets,
+        #   uint32_t nfields, yyjson_val **out)
+        @yyjson_obj_collect = @mod.functions.add("konpeito_yyjson_obj_collect",
+          [ptr_type, LLVM::Int32, LLVM::Int32, ptr_type, ptr_type, ptr_type, LLVM::Int32, ptr_type],
+          LLVM.Void)
+
+        # generate_as runtime (stdlib/json/json_encoder.c)
+        # VALUE konpeito_json_enc_new(long capa)
+        @json_enc_new = @mod.functions.add("konpeito_json_enc_new",
+          [LLVM::Int64], value_type)
+
+        # void konpeito_json_enc_int(VALUE buf, int64_t num)
+        @json_enc_int = @mod.functions.add("konpeito_json_enc_int",
+          [value_type, LLVM::Int64], LLVM.Void)
+
+        # void konpeito_json_enc_real(VALUE buf, double num)
+        @json_enc_real = @mod.functions.add("konpeito_json_enc_real",
+          [value_type, LLVM::Double], LLVM.Void)
+
+        # void konpeito_json_enc_value(VALUE buf, VALUE obj)
+        @json_enc_value = @mod.functions.add("konpeito_json_enc_value",
+          [value_type, value_type], LLVM.Void)
       end
 
       # Declare CRuby builtin method functions for direct calls
@@ -2417,6 +2442,10 @@ module Konpeito
           generate_json_parse_as(inst)
         when HIR::JSONParseArrayAs
           generate_json_parse_array_as(inst)
+        when HIR::JSONGenerateAs
+          generate_json_generate_as(inst)
+        when HIR::JSONGenerateArrayAs
+          generate_json_generate_array_as(inst)
         # NativeHash operations
         when HIR::NativeHashAlloc
           generate_native_hash_alloc(inst)
@@ -3489,6 +3518,13 @@ module Konpeito
           end
         end
 
+        # KonpeitoShell.each_line(path) { |line| ... } - inline mmap + memchr loop
+        if inst.block && can_inline_shell_each_line?(inst)
+          result = generate_inline_shell_each_line(inst)
+          @variables[inst.result_var] = result if inst.result_var
+          return result
+        end
+
         # Try builtin method direct call (devirtualization)
         receiver_type = get_type(inst.receiver)
         builtin = lookup_builtin_method(receiver_type, inst.method_name)
@@ -4583,6 +4619,329 @@ module Konpeito
         receiver
       end
 
+      # Check if KonpeitoShell.each_line can be inlined
+      def can_inline_shell_each_line?(inst)
+        return false unless @builder&.insert_block
+        return false unless inst.method_name.to_s == "each_line"
+        return false unless inst.receiver.is_a?(HIR::ConstantLookup) && inst.receiver.name.to_s == "KonpeitoShell"
+        return false unless inst.args.size == 1
+
+        inst.block.params.size <= 1
+      end
+
+      # Generate inline KonpeitoShell.each_line loop
+      # KonpeitoShell.each_line(path) { |line| ... } maps the file once, then
+      # finds each newline with memchr (vectorized in libc) and binds line to
+      # a ByteSlice over the mapping, newline excluded. Nothing is copied or
+      # allocated per line.
+      #
+      # The loop runs in a body callback under rb_ensure, so the mapping is
+      # released however the block exits: after the last line, on break, on
+      # return (which then returns from the enclosing method) or when the
+      # block raises.
+      def generate_inline_shell_each_line(inst)
+        mmap_type = TypeChecker::Types::CFuncType.new("konpeito_shell_mmap_file", [:String], :ByteSlice)
+        mmap_fn = declare_cfunc(mmap_type)
+        block = inst.block
+
+        if @current_native_class && block.body.any? { |bb| bb.terminator.is_a?(HIR::Return) }
+          raise "return inside KonpeitoShell.each_line is not supported in NativeClass methods"
+        end
+
+        # Map the file: data/len stay fixed for the whole loop
+        path_value, path_type = get_value_with_type(inst.args.first)
+        path_cstr = convert_to_cfunc_arg(path_value, path_type, :String)
+        len_out = entry_block_alloca(LLVM::Int64, "each_line_len_out")
+        @builder.store(LLVM::Int64.from_i(0), len_out)
+        data = @builder.call(mmap_fn, path_cstr, len_out, "each_line_data")
+        len = @builder.load2(LLVM::Int64, len_out, "each_line_len")
+
+        # Captures: variables with an alloca are shared by pointer, so writes
+        # in the block propagate; SSA-only values (native pointers) are
+        # spilled and passed by value
+        captures = []
+        block.captures.each do |capture|
+          name = capture.name
+          tag = @variable_types[name] || :value
+          if @variable_allocas[name]
+            captures << [name, @variable_allocas[name], tag, nil]
+          elsif @variables[name].is_a?(LLVM::Value)
+            value = @variables[name]
+            slot = entry_block_alloca(value.type, "each_line_cap_#{name}")
+            @builder.store(value, slot)
+            captures << [name, slot, tag, value.type]
+            if (len_value = @variables["#{name}_len"])
+              len_slot = entry_block_alloca(LLVM::Int64, "each_line_cap_#{name}_len")
+              @builder.store(len_value, len_slot)
+              captures << ["#{name}_len", len_slot, :i64, LLVM::Int64]
+            end
+          end
+        end
+
+        captures_value = LLVM::Int64.from_i(0)
+        unless captures.empty?
+          array_type = LLVM::Array(LLVM::Pointer(value_type), captures.size)
+          captures_array = entry_block_alloca(array_type, "each_line_captures")
+          captures.each_with_index do |(name, slot, _tag, _type), i|
+            elem_ptr = @builder.gep2(array_type, captures_array,
+              [LLVM::Int32.from_i(0), LLVM::Int32.from_i(i)], "each_line_cap_#{name}_ptr")
+            @builder.store(slot, elem_ptr)
+          end
+          captures_value = @builder.ptr2int(captures_array, value_type, "each_line_captures_int")
+        end
+
+        frame_type = get_shell_each_line_frame_struct
+        frame = entry_block_alloca(frame_type, "each_line_frame")
+        [data, len, LLVM::Int64.from_i(0), qnil, get_self_value, captures_value].each_with_index do |value, i|
+          field = @builder.gep2(frame_type, frame, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(i)], "each_line_frame_#{i}")
+          @builder.store(value, field)
+        end
+        frame_value = @builder.ptr2int(frame, value_type, "each_line_frame_int")
+
+        body_fn = generate_shell_each_line_body(block, captures)
+        @builder.call(@rb_ensure, body_fn, frame_value, declare_shell_each_line_ensure, frame_value)
+
+        # A return in the block leaves the enclosing method once the mapping is released
+        returned_field = @builder.gep2(frame_type, frame, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(2)], "each_line_returned_ptr")
+        returned = @builder.load2(LLVM::Int64, returned_field, "each_line_returned")
+        func = @builder.insert_block.parent
+        return_block = func.basic_blocks.append("each_line_return")
+        done_block = func.basic_blocks.append("each_line_done")
+        @builder.cond(@builder.icmp(:ne, returned, LLVM::Int64.from_i(0)), return_block, done_block)
+
+        @builder.position_at_end(return_block)
+        retval_field = @builder.gep2(frame_type, frame, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(3)], "each_line_retval_ptr")
+        insert_profile_exit_probe
+        emit_ret(@builder.load2(value_type, retval_field, "each_line_retval"))
+
+        @builder.position_at_end(done_block)
+        # Phis that name the enclosing HIR block must see done_block as its exit
+        @block_exit_overrides[@generating_block_label] = done_block if @generating_block_label
+        qnil
+      end
+
+      # { ptr data, i64 len, i64 returned, VALUE retval, VALUE self, VALUE captures }
+      def get_shell_each_line_frame_struct
+        @shell_each_line_frame_struct ||= LLVM::Struct(
+          LLVM::Pointer(LLVM::Int8), LLVM::Int64, LLVM::Int64, value_type, value_type, value_type,
+          "EachLineFrame"
+        )
+      end
+
+      # rb_ensure callback that releases the mapping: VALUE f(VALUE frame)
+      def declare_shell_each_line_ensure
+        return @shell_each_line_ensure if @shell_each_line_ensure
+
+        unmap_type = TypeChecker::Types::CFuncType.new("konpeito_shell_unmap_file", [:ByteSlice], :Integer)
+        unmap_fn = declare_cfunc(unmap_type)
+        frame_type = get_shell_each_line_frame_struct
+
+        func = @mod.functions.add("konpeito_shell_each_line_ensure", [value_type], value_type)
+        func.linkage = :internal
+
+        # Separate builder so the caller's insertion point is untouched
+        eb = LLVM::Builder.new
+        eb.position_at_end(func.basic_blocks.append("entry"))
+        frame = eb.int2ptr(func.params[0], LLVM::Pointer(frame_type), "frame")
+        data_field = eb.gep2(frame_type, frame, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(0)], "data_ptr")
+        len_field = eb.gep2(frame_type, frame, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(1)], "len_ptr")
+        eb.call(unmap_fn,
+          eb.load2(LLVM::Pointer(LLVM::Int8), data_field, "data"),
+          eb.load2(LLVM::Int64, len_field, "len"))
+        eb.ret(qnil)
+        eb.dispose
+
+        @shell_each_line_ensure = func
+      end
+
+      # rb_ensure body for each_line: VALUE f(VALUE frame). Runs the line
+      # loop with the block body inlined. next continues with the following
+      # line, break leaves the loop, and return stores its value in the frame
+      # for the caller to return.
+      def generate_shell_each_line_body(block, captures)
+        declare_memchr
+        @shell_each_line_counter ||= 0
+        @shell_each_line_counter += 1
+        func = @mod.functions.add("shell_each_line_body_#{@shell_each_line_counter}", [value_type], value_type)
+        func.linkage = :internal
+        frame_type = get_shell_each_line_frame_struct
+
+        # Save current builder state
+        saved_block = @builder.insert_block
+        saved_vars = @variables
+        saved_types = @variable_types
+        saved_allocas = @variable_allocas
+        saved_blocks = @blocks.dup
+        saved_return_blocks = @return_blocks
+        saved_in_block_callback = @in_block_callback
+        saved_block_callback_self = @block_callback_self
+        saved_mrb_cache = save_mrb_constant_cache
+        saved_current_function = @current_function
+        saved_gc_arena_alloca = @mruby_gc_arena_alloca
+        saved_generating_block_label = @generating_block_label
+
+        entry = func.basic_blocks.append("entry")
+        @builder.position_at_end(entry)
+
+        # Reset variable tracking for the callback scope, as for block callbacks
+        @in_block_callback = true
+        @mruby_gc_arena_alloca = nil
+        @variables = {}
+        @variable_types = {}
+        @variable_allocas = {}
+        reset_mrb_constant_cache
+        @current_function = func
+
+        frame = @builder.int2ptr(func.params[0], LLVM::Pointer(frame_type), "frame")
+        frame_field = ->(i, name) { @builder.gep2(frame_type, frame, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(i)], name) }
+        data = @builder.load2(LLVM::Pointer(LLVM::Int8), frame_field.(0, "data_ptr"), "data")
+        len = @builder.load2(LLVM::Int64, frame_field.(1, "len_ptr"), "len")
+        @block_callback_self = @builder.load2(value_type, frame_field.(4, "self_ptr"), "each_line_self")
+
+        unless captures.empty?
+          array_type = LLVM::Array(LLVM::Pointer(value_type), captures.size)
+          captures_int = @builder.load2(value_type, frame_field.(5, "captures_ptr"), "captures_int")
+          captures_ptr = @builder.int2ptr(captures_int, LLVM::Pointer(array_type), "captures")
+          captures.each_with_index do |(name, _slot, tag, by_value_type), i|
+            elem_ptr_ptr = @builder.gep2(array_type, captures_ptr,
+              [LLVM::Int32.from_i(0), LLVM::Int32.from_i(i)], "cap_#{name}_ptr_ptr")
+            elem_ptr = @builder.load2(LLVM::Pointer(value_type), elem_ptr_ptr, "cap_#{name}_ptr")
+            if by_value_type
+              @variables[name] = @builder.load2(by_value_type, elem_ptr, "cap_#{name}")
+            else
+              @variable_allocas[name] = elem_ptr
+            end
+            @variable_types[name] = tag
+          end
+        end
+
+        # Pre-allocate allocas for block-local variables
+        excluded_names = captures.map(&:first) + block.params.map(&:name)
+        collect_local_variables_in_block(block).each do |var_name, var_type|
+          next if excluded_names.include?(var_name)
+
+          llvm_type, type_tag = llvm_type_for_ruby_type(var_type)
+          @variable_allocas[var_name] = @builder.alloca(llvm_type, "each_line_blk_#{var_name}")
+          @variable_types[var_name] = type_tag
+        end
+
+        # One ByteSlice and one cursor, reused by every iteration
+        slice_struct = get_byte_slice_struct
+        line_slice = @builder.alloca(slice_struct, "each_line_slice")
+        slice_data_field = @builder.gep2(slice_struct, line_slice, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(0)], "line_data_field")
+        slice_len_field = @builder.gep2(slice_struct, line_slice, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(1)], "line_len_field")
+        pos_alloca = @builder.alloca(LLVM::Int64, "each_line_pos")
+        @builder.store(LLVM::Int64.from_i(0), pos_alloca)
+
+        if block.params.size == 1
+          line_param = block.params[0].name
+          @variables[line_param] = line_slice
+          @variable_types[line_param] = :byte_slice
+        end
+
+        loop_cond = func.basic_blocks.append("each_line_cond")
+        loop_body = func.basic_blocks.append("each_line_body")
+        loop_next = func.basic_blocks.append("each_line_next")
+        loop_end = func.basic_blocks.append("each_line_end")
+
+        block.body.each do |hir_block|
+          @blocks[hir_block.label] = func.basic_blocks.append(hir_block.label)
+        end
+        @blocks[block.next_label] = loop_next if block.next_label
+        @blocks[block.break_label] = loop_end if block.break_label
+        @return_blocks = Set.new
+        block.body.each do |hir_block|
+          @return_blocks << hir_block.label if hir_block.terminator.is_a?(HIR::Return)
+        end
+
+        @builder.br(loop_cond)
+
+        # Loop condition: pos < len
+        @builder.position_at_end(loop_cond)
+        pos = @builder.load2(LLVM::Int64, pos_alloca, "pos")
+        @builder.cond(@builder.icmp(:slt, pos, len), loop_body, loop_end)
+
+        # Loop body: line = data[pos, memchr(..., "\n") - start]
+        @builder.position_at_end(loop_body)
+        line_start = @builder.gep2(LLVM::Int8, data, [pos], "line_start")
+        remaining = @builder.sub(len, pos, "remaining")
+        newline = @builder.call(@memchr, line_start, LLVM::Int32.from_i(10), remaining, "newline")
+        no_newline = @builder.icmp(:eq, newline, LLVM::Pointer(LLVM::Int8).null, "no_newline")
+        found_len = @builder.sub(
+          @builder.ptr2int(newline, LLVM::Int64, "newline_addr"),
+          @builder.ptr2int(line_start, LLVM::Int64, "line_addr"),
+          "found_len"
+        )
+        line_len = @builder.select(no_newline, remaining, found_len, "line_len")
+        @builder.store(line_start, slice_data_field)
+        @builder.store(line_len, slice_len_field)
+        @builder.br(@blocks[block.body.first.label])
+
+        # Block body, with its control flow
+        sort_blocks_by_phi_dependencies(block.body).each do |hir_block|
+          @builder.position_at_end(@blocks[hir_block.label])
+          @generating_block_label = hir_block.label
+          rescue_owned = collect_rescue_owned_instructions(hir_block.instructions)
+          hir_block.instructions.each do |body_inst|
+            next if rescue_owned.include?(body_inst.object_id)
+            generate_instruction(body_inst)
+          end
+
+          case (term = hir_block.terminator)
+          when HIR::Return
+            value, type_tag = term.value ? get_value_with_type(term.value) : [qnil, :value]
+            @builder.store(convert_value(value, type_tag, :value), frame_field.(3, "retval_ptr"))
+            @builder.store(LLVM::Int64.from_i(1), frame_field.(2, "returned_ptr"))
+            @builder.br(loop_end)
+          when nil
+            # End of the body: on to the next line
+            @builder.br(loop_next)
+          else
+            generate_terminator(term)
+          end
+        end
+
+        # Advance past the line and its newline
+        @builder.position_at_end(loop_next)
+        @builder.store(@builder.add(@builder.add(pos, line_len), LLVM::Int64.from_i(1), "next_pos"), pos_alloca)
+        @builder.br(loop_cond)
+
+        @builder.position_at_end(loop_end)
+        @builder.ret(qnil)
+
+        # Restore builder state
+        @builder.position_at_end(saved_block)
+        @variables = saved_vars
+        @variable_types = saved_types
+        @variable_allocas = saved_allocas
+        @blocks = saved_blocks
+        @return_blocks = saved_return_blocks
+        @in_block_callback = saved_in_block_callback
+        @block_callback_self = saved_block_callback_self
+        restore_mrb_constant_cache(saved_mrb_cache)
+        @current_function = saved_current_function
+        @mruby_gc_arena_alloca = saved_gc_arena_alloca
+        @generating_block_label = saved_generating_block_label
+
+        func
+      end
+
+      # Alloca in the current function's entry block, so a call site inside
+      # a loop reuses one stack slot instead of growing the frame per iteration
+      def entry_block_alloca(type, name)
+        saved_block = @builder.insert_block
+        entry_block = saved_block.parent.basic_blocks.first
+        first_inst = entry_block.instructions.first
+        if first_inst
+          @builder.position_before(first_inst)
+        else
+          @builder.position_at_end(entry_block)
+        end
+        slot = @builder.alloca(type, name)
+        @builder.position_at_end(saved_block)
+        slot
+      end
+
       # Generate inline Array#find/detect loop with early termination
       # arr.find { |x| cond } becomes: for each elem, if cond then return elem; return nil
       def generate_inline_array_find(inst)
@@ -11573,7 +11932,6 @@ module Konpeito
       # Create ByteSlice from ByteBuffer
       def generate_byte_buffer_slice(inst)
         buffer_struct = get_byte_buffer_struct
-        slice_struct = get_byte_slice_struct
         buffer_ptr = get_value(inst.buffer)
 
         # Get start and length
@@ -11590,21 +11948,28 @@ module Konpeito
         # Calculate slice data pointer (use gep2 with i8 element type)
         slice_data = @builder.gep2(LLVM::Int8, data_ptr, [start_i64], "slice_data")
 
-        # Allocate slice struct on stack
+        slice_ptr = build_byte_slice(slice_data, length_i64)
+
+        if inst.result_var
+          @variables[inst.result_var] = slice_ptr
+          @variable_types[inst.result_var] = :byte_slice
+        end
+
+        slice_ptr
+      end
+
+      # Allocate a ByteSlice struct on the stack over (data, length)
+      def build_byte_slice(data_ptr, length_i64)
+        slice_struct = get_byte_slice_struct
         slice_ptr = @builder.alloca(slice_struct, "byteslice")
 
         # Store data pointer and length
         slice_data_field = @builder.gep2(slice_struct, slice_ptr, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(0)], "slice_data_field")
-        @builder.store(slice_data, slice_data_field)
+        @builder.store(data_ptr, slice_data_field)
 
         slice_len_field = @builder.gep2(slice_struct, slice_ptr, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(1)], "slice_len_field")
         @builder.store(length_i64, slice_len_field)
 
-        if inst.result_var
-          @variables[inst.result_var] = slice_ptr
-          @variable_types[inst.result_var] = :byte_slice
-        end
-
         slice_ptr
       end
 
@@ -13000,11 +13365,14 @@ module Konpeito
         fields = target_class.fields
         field_offset = 0  # Adjust if vtable is used
 
+        # Collect all known fields in one pass over the object's members
+        field_vals = entry_block_alloca(LLVM::Array(ptr_type, [fields.size, 1].max), "json_fields")
+        generate_json_field_collect(target_class, root, field_vals)
+
         # Process each field
         fields.each_with_index do |(field_name, field_type), idx|
           # Get JSON value for this field
-          field_key = @builder.global_string_pointer(field_name.to_s)
-          field_val = @builder.call(@yyjson_obj_get, root, field_key, "field_#{field_name}")
+          field_val = load_json_field_value(fields, field_vals, idx, "field_#{field_name}")
 
           # Get struct field pointer
           field_ptr = @builder.gep2(llvm_struct, struct_ptr,
@@ -13110,6 +13478,10 @@ module Konpeito
         body_bb = @current_function.basic_blocks.append("json_arr_body")
         done_bb = @current_function.basic_blocks.append("json_arr_done")
 
+        # Per-element field slots, reused across iterations
+        fields = element_class.fields
+        field_vals = entry_block_alloca(LLVM::Array(ptr_type, [fields.size, 1].max), "json_arr_fields")
+
         # Initialize loop counter
         idx_alloca = @builder.alloca(LLVM::Int64, "json_arr_idx")
         @builder.store(LLVM::Int64.from_i(0), idx_alloca)
@@ -13131,12 +13503,11 @@ module Konpeito
         struct_ptr = @builder.gep2(llvm_elem_type, array_ptr, [idx], "elem_struct_ptr")
 
         # Parse fields from JSON object into struct
-        fields = element_class.fields
         field_offset = 0
+        generate_json_field_collect(element_class, elem_val, field_vals)
 
         fields.each_with_index do |(field_name, field_type), fidx|
-          field_key = @builder.global_string_pointer(field_name.to_s)
-          field_val = @builder.call(@yyjson_obj_get, elem_val, field_key, "arr_field_#{field_name}")
+          field_val = load_json_field_value(fields, field_vals, fidx, "arr_field_#{field_name}")
 
           field_ptr = @builder.gep2(llvm_struct, struct_ptr,
                                     [LLVM::Int32.from_i(0), LLVM::Int32.from_i(field_offset + fidx)],
@@ -13201,6 +13572,299 @@ module Konpeito
         array_ptr
       end
 
+      # ========================================
+      # JSON generation
+      # Direct NativeClass to JSON conversion
+      # ========================================
+
+      # Serialize a NativeClass instance to a JSON String
+      # Fields are read straight from the struct; keys are constant fragments
+      def generate_json_generate_as(inst)
+        class_type = inst.target_class
+
+        # Value struct vars hold a pointer to their alloca, like reference types
+        var_name = inst.object_expr.is_a?(HIR::LoadLocal) ? inst.object_expr.var.name : nil
+        object_ptr = if var_name && is_value_struct_var?(var_name)
+          @variables[var_name]
+        else
+          get_native_class_ptr(inst.object_expr)
+        end
+
+        buf = @builder.call(@json_enc_new, LLVM::Int64.from_i(json_encode_size_hint(class_type)), "json_buf")
+        @builder.call(get_or_create_json_encoder(class_type), buf, object_ptr)
+
+        if inst.result_var
+          @variables[inst.result_var] = buf
+          @variable_types[inst.result_var] = :value
+        end
+
+        buf
+      end
+
+      # Serialize a NativeArray[NativeClass] to a JSON array String
+      def generate_json_generate_array_as(inst)
+        element_class = inst.element_class
+        llvm_struct = get_or_create_native_class_struct(element_class)
+        encoder = get_or_create_json_encoder(element_class)
+
+        array_ptr = get_native_array_ptr(inst.array_expr)
+        arr_len = @variables["#{get_receiver_var_name(inst.array_expr)}_len"]
+        arr_len ||= @variables["#{inst.array_expr.var.name}_len"] if inst.array_expr.is_a?(HIR::LoadLocal)
+        unless arr_len
+          raise "KonpeitoJSON.generate_array_as: the length of this NativeArray[#{element_class.name}] is not known here; " \
+                "pass a local NativeArray variable"
+        end
+
+        # Pre-size the output from the per-element estimate
+        capa = @builder.mul(arr_len, LLVM::Int64.from_i(json_encode_size_hint(element_class) + 1), "json_arr_capa")
+        capa = @builder.add(capa, LLVM::Int64.from_i(2), "json_arr_capa2")
+        buf = @builder.call(@json_enc_new, capa, "json_arr_buf")
+        @builder.call(@rb_str_cat, buf, @builder.global_string_pointer("["), LLVM::Int64.from_i(1))
+
+        loop_bb = @current_function.basic_blocks.append("json_gen_loop")
+        body_bb = @current_function.basic_blocks.append("json_gen_body")
+        done_bb = @current_function.basic_blocks.append("json_gen_done")
+
+        idx_alloca = entry_block_alloca(LLVM::Int64, "json_gen_idx")
+        @builder.store(LLVM::Int64.from_i(0), idx_alloca)
+        @builder.br(loop_bb)
+
+        @builder.position_at_end(loop_bb)
+        idx = @builder.load2(LLVM::Int64, idx_alloca, "idx")
+        cond = @builder.icmp(:ult, idx, arr_len, "json_gen_cond")
+        @builder.cond(cond, body_bb, done_bb)
+
+        # Separator is "," for every element but the first (zero-length append)
+        @builder.position_at_end(body_bb)
+        is_first = @builder.icmp(:eq, idx, LLVM::Int64.from_i(0), "json_gen_first")
+        sep_len = @builder.select(is_first, LLVM::Int64.from_i(0), LLVM::Int64.from_i(1), "json_gen_sep_len")
+        @builder.call(@rb_str_cat, buf, @builder.global_string_pointer(","), sep_len)
+
+        elem_ptr = @builder.gep2(llvm_struct, array_ptr, [idx], "json_gen_elem")
+        @builder.call(encoder, buf, elem_ptr)
+
+        next_idx = @builder.add(idx, LLVM::Int64.from_i(1), "next_idx")
+        @builder.store(next_idx, idx_alloca)
+        @builder.br(loop_bb)
+
+        @builder.position_at_end(done_bb)
+        @builder.call(@rb_str_cat, buf, @builder.global_string_pointer("]"), LLVM::Int64.from_i(1))
+
+        if inst.result_var
+          @variables[inst.result_var] = buf
+          @variable_types[inst.result_var] = :value
+        end
+
+        buf
+      end
+
+      # Per-class encoder: void json_encode_<Class>(VALUE buf, Native_<Class> *obj)
+      # Generated once and shared by generate_as, generate_array_as and by
+      # classes that embed or reference this one.
+      def get_or_create_json_encoder(class_type)
+        @json_encoders ||= {}
+        return @json_encoders[class_type.name] if @json_encoders[class_type.name]
+
+        func = @mod.functions.add("json_encode_#{class_type.name}", [value_type, ptr_type], LLVM.Void)
+        func.linkage = :internal
+        # Register before emitting the body so self-referencing classes resolve
+        @json_encoders[class_type.name] = func
+
+        saved_block = @builder.insert_block
+        saved_function = @current_function
+        saved_mrb_cache = save_mrb_constant_cache
+        reset_mrb_constant_cache
+        @current_function = func
+
+        @builder.position_at_end(func.basic_blocks.append("entry"))
+        generate_json_encoder_body(class_type, func.params[0], func.params[1])
+        @builder.ret_void
+
+        @current_function = saved_function
+        restore_mrb_constant_cache(saved_mrb_cache)
+        @builder.position_at_end(saved_block)
+
+        func
+      end
+
+      # Emit the field writers for class_type. Constant text (braces, commas,
+      # quoted keys, literal nulls) is accumulated and appended in one rb_str_cat
+      # right before each dynamic value.
+      def generate_json_encoder_body(class_type, buf, obj_ptr)
+        llvm_struct = get_or_create_native_class_struct(class_type)
+        base_index = class_uses_vtable?(class_type) ? 1 : 0
+        pending = +"{"
+
+        flush = lambda do
+          next if pending.empty?
+          @builder.call(@rb_str_cat, buf, @builder.global_string_pointer(pending),
+                        LLVM::Int64.from_i(pending.bytesize))
+          pending = +""
+        end
+
+        class_type.fields.each_with_index do |(field_name, field_type), idx|
+          pending << "," if idx > 0
+          pending << "\"#{field_name}\":"
+          field_ptr = @builder.struct_gep2(llvm_struct, obj_ptr, base_index + idx, "#{field_name}_ptr")
+
+          case field_type
+          when :Int64, :Integer
+            flush.call
+            i64_val = @builder.load2(LLVM::Int64, field_ptr, "#{field_name}_i64")
+            @builder.call(@json_enc_int, buf, i64_val)
+          when :Float64, :Float
+            flush.call
+            f64_val = @builder.load2(LLVM::Double, field_ptr, "#{field_name}_f64")
+            @builder.call(@json_enc_real, buf, f64_val)
+          when :Bool
+            flush.call
+            i8_val = @builder.load2(LLVM::Int8, field_ptr, "#{field_name}_i8")
+            is_true = @builder.icmp(:ne, i8_val, LLVM::Int8.from_i(0), "#{field_name}_is_true")
+            lit = @builder.select(is_true, @builder.global_string_pointer("true"),
+                                  @builder.global_string_pointer("false"), "#{field_name}_lit")
+            lit_len = @builder.select(is_true, LLVM::Int64.from_i(4), LLVM::Int64.from_i(5), "#{field_name}_lit_len")
+            @builder.call(@rb_str_cat, buf, lit, lit_len)
+          when :String, :Object, :Array, :Hash
+            flush.call
+            # Unset VALUE fields are zero (Qfalse); write them as null
+            obj_val = @builder.load2(value_type, field_ptr, "#{field_name}_val")
+            is_unset = @builder.icmp(:eq, obj_val, LLVM::Int64.from_i(0), "#{field_name}_unset")
+            obj_val = @builder.select(is_unset, qnil, obj_val, "#{field_name}_or_nil")
+            @builder.call(@json_enc_value, buf, obj_val)
+          else
+            embedded_class = field_type.is_a?(Symbol) && @native_class_type_registry[field_type]
+            ref_class = field_type.is_a?(Hash) && @native_class_type_registry[field_type[:ref]]
+
+            if embedded_class
+              # Embedded struct: encode in place
+              flush.call
+              @builder.call(get_or_create_json_encoder(embedded_class), buf, field_ptr)
+            elsif ref_class
+              # Reference: null or the referenced object
+              flush.call
+              ref_ptr = @builder.load2(ptr_type, field_ptr, "#{field_name}_ref")
+              is_null = @builder.icmp(:eq, ref_ptr, LLVM::Pointer(LLVM::Int8).null, "#{field_name}_is_null")
+
+              null_bb = @current_function.basic_blocks.append("json_null_#{field_name}")
+              ref_bb = @current_function.basic_blocks.append("json_ref_#{field_name}")
+              cont_bb = @current_function.basic_blocks.append("json_cont_#{field_name}")
+              @builder.cond(is_null, null_bb, ref_bb)
+
+              @builder.position_at_end(null_bb)
+              @builder.call(@rb_str_cat, buf, @builder.global_string_pointer("null"), LLVM::Int64.from_i(4))
+              @builder.br(cont_bb)
+
+              @builder.position_at_end(ref_bb)
+              @builder.call(get_or_create_json_encoder(ref_class), buf, ref_ptr)
+              @builder.br(cont_bb)
+
+              @builder.position_at_end(cont_bb)
+            else
+              raise "KonpeitoJSON.generate_as: field #{class_type.name}##{field_name} has type #{field_type}, " \
+                    "which cannot be encoded as JSON"
+            end
+          end
+        end
+
+        pending << "}"
+        flush.call
+      end
+
+      # Rough encoded size of one instance, used to pre-size the output String
+      def json_encode_size_hint(class_type)
+        class_type.fields.keys.sum { |name| name.to_s.bytesize + 4 + 16 } + 2
+      end
+
+      # Fill field_vals ([N x ptr]) with the yyjson value of each field of
+      # class_type found in obj (NULL when absent), in a single pass
+      def generate_json_field_collect(class_type, obj, field_vals)
+        fields = class_type.fields
+        return if fields.empty?
+
+        table = json_field_table(class_type)
+        @builder.call(@yyjson_obj_collect, obj,
+                      LLVM::Int32.from_i(table[:seed]),
+                      LLVM::Int32.from_i(table[:mask]),
+                      @builder.bit_cast(table[:slots], ptr_type, "json_slots"),
+                      @builder.bit_cast(table[:names], ptr_type, "json_names"),
+                      @builder.bit_cast(table[:offsets], ptr_type, "json_offsets"),
+                      LLVM::Int32.from_i(fields.size),
+                      @builder.bit_cast(field_vals, ptr_type, "json_fields_i8"))
+      end
+
+      # Load the collected yyjson value for field idx (NULL when absent)
+      def load_json_field_value(fields, field_vals, idx, name)
+        return LLVM::Pointer(LLVM::Int8).null if fields.empty?
+
+        slot_ptr = @builder.gep2(LLVM::Array(ptr_type, fields.size), field_vals,
+                                 [LLVM::Int32.from_i(0), LLVM::Int32.from_i(idx)],
+                                 "#{name}_slot")
+        @builder.load2(ptr_type, slot_ptr, name)
+      end
+
+      # Build (once per class) the constant perfect-hash tables used by
+      # konpeito_yyjson_obj_collect. Grows the table until some seed maps
+      # every field name to a distinct slot.
+      def json_field_table(class_type)
+        @json_field_tables ||= {}
+        @json_field_tables[class_type.name] ||= begin
+          names = class_type.fields.keys.map(&:to_s)
+          size = 1
+          size <<= 1 while size < names.size * 2
+          seed = slots = nil
+
+          until slots
+            (0...256).each do |candidate|
+              table = Array.new(size, -1)
+              perfect = names.each_with_index.all? do |name, idx|
+                slot = json_field_hash(name, candidate) & (size - 1)
+                next false unless table[slot] == -1
+                table[slot] = idx
+              end
+              if perfect
+                seed = candidate
+                slots = table
+                break
+              end
+            end
+            size <<= 1 unless slots
+          end
+
+          offsets = [0]
+          blob = +""
+          names.each do |name|
+            blob << name << "\0"
+            offsets << blob.bytesize
+          end
+
+          prefix = "json_fields_#{class_type.name}"
+          {
+            seed: seed,
+            mask: size - 1,
+            slots: json_field_const_global("#{prefix}_slots", LLVM::Int32, slots),
+            names: json_field_const_global("#{prefix}_names", LLVM::Int8, blob.bytes),
+            offsets: json_field_const_global("#{prefix}_offsets", LLVM::Int32, offsets)
+          }
+        end
+      end
+
+      # 32-bit FNV-1a over (length, bytes) with a folded high half.
+      # Must match konpeito_field_hash in stdlib/json/yyjson_wrapper.c.
+      def json_field_hash(name, seed)
+        h = 0x811C9DC5 ^ seed
+        h = ((h ^ name.bytesize) * 0x01000193) & 0xFFFFFFFF
+        name.each_byte { |b| h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF }
+        h ^ (h >> 16)
+      end
+
+      def json_field_const_global(name, elem_type, values)
+        @mod.globals.add(LLVM::Array(elem_type, values.size), name) do |var|
+          var.linkage = :internal
+          var.global_constant = true
+          var.initializer = LLVM::ConstantArray.const(elem_type, values.map { |v| elem_type.from_i(v) })
+        end
+      end
+
       # Calculate size of NativeClass struct in bytes
       def calculate_native_class_size(class_type)
         size = 0
@@ -13521,37 +14185,138 @@ module Konpeito
         cfunc_type = inst.cfunc_type
         func = declare_cfunc(cfunc_type)
 
-        # Convert arguments with type coercion
-        call_args = inst.args.each_with_index.map do |arg, i|
-          arg_value, arg_type_tag = get_value_with_type(arg)
+        # Convert arguments with type coercion; native buffers expand to (ptr, len)
+        call_args = inst.args.each_with_index.flat_map do |arg, i|
           expected_type = cfunc_type.param_types[i]
-          convert_to_cfunc_arg(arg_value, arg_type_tag, expected_type)
+          if TypeChecker::Types::CFuncType.buffer_param?(expected_type)
+            convert_to_cfunc_buffer_args(arg, expected_type, cfunc_type.c_func_name, i)
+          else
+            arg_value, arg_type_tag = get_value_with_type(arg)
+            [convert_to_cfunc_arg(arg_value, arg_type_tag, expected_type)]
+          end
         end
 
         # Call the C function
-        result = if cfunc_type.return_type == :void
-          @builder.call(func, *call_args)
-          qnil
+        result, result_type_tag = if cfunc_type.return_type == :void
+          emit_cfunc_call(func, cfunc_type, call_args)
+          [qnil, :value]
+        elsif cfunc_type.ptr_len_return?
+          # (ptr, len) convention: the callee stores the length through a
+          # trailing int64_t*, and the bytes are copied with rb_str_new so
+          # embedded NULs survive
+          len_out = entry_block_alloca(LLVM::Int64, "cfunc_len_out")
+          @builder.store(LLVM::Int64.from_i(0), len_out)
+          raw_result = emit_cfunc_call(func, cfunc_type, call_args + [len_out])
+          len_val = @builder.load2(LLVM::Int64, len_out, "cfunc_len")
+          if cfunc_type.return_type == :ByteSlice
+            # Zero-copy view: the memory stays owned by the C side
+            [build_byte_slice(raw_result, len_val), :byte_slice]
+          else
+            [@builder.call(@rb_str_new, raw_result, len_val, "cfunc_str"), :value]
+          end
         else
-          raw_result = @builder.call(func, *call_args, "cfunc_result")
-          convert_from_cfunc_result(raw_result, cfunc_type.return_type)
+          raw_result = emit_cfunc_call(func, cfunc_type, call_args)
+          cfunc_result_with_type(raw_result, cfunc_type.return_type)
         end
 
         if inst.result_var
           @variables[inst.result_var] = result
-          @variable_types[inst.result_var] = :value
+          @variable_types[inst.result_var] = result_type_tag
         end
 
         result
       end
 
+      # Call an already-marshalled cfunc. %a{nogvl} functions run through
+      # rb_thread_call_without_gvl on CRuby; mruby has no GVL, so they are
+      # called directly there. Returns the raw C result (nil for void).
+      def emit_cfunc_call(func, cfunc_type, args)
+        if cfunc_type.nogvl && @runtime != :mruby
+          emit_cfunc_call_without_gvl(cfunc_type, args)
+        elsif cfunc_type.return_type == :void
+          @builder.call(func, *args)
+          nil
+        else
+          @builder.call(func, *args, "cfunc_result")
+        end
+      end
+
+      # Arguments are stored into a stack frame { args..., result } that the
+      # trampoline unpacks on the other side of the GVL release. Only C values
+      # (numerics and buffer pointers) are in the frame, so no Ruby object is
+      # touched while the lock is dropped.
+      def emit_cfunc_call_without_gvl(cfunc_type, args)
+        trampoline, frame_type = declare_cfunc_nogvl_trampoline(cfunc_type)
+
+        frame = entry_block_alloca(frame_type, "nogvl_frame")
+        args.each_with_index do |arg, i|
+          field = @builder.gep2(frame_type, frame, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(i)], "nogvl_arg_#{i}")
+          @builder.store(arg, field)
+        end
+
+        null = LLVM::Pointer(LLVM::Int8).null
+        frame_ptr = @builder.bit_cast(frame, ptr_type, "nogvl_frame_ptr")
+        @builder.call(declare_rb_thread_call_without_gvl, trampoline, frame_ptr, null, null)
+
+        return nil if cfunc_type.return_type == :void
+
+        result_field = @builder.gep2(frame_type, frame, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(args.size)], "nogvl_result_ptr")
+        @builder.load2(cfunc_type_to_llvm(cfunc_type.return_type), result_field, "cfunc_result")
+      end
+
+      # void *konpeito_nogvl_<c_func_name>(void *frame): unpack the frame,
+      # call the C function and store its result back into the frame
+      def declare_cfunc_nogvl_trampoline(cfunc_type)
+        @cfunc_nogvl_trampolines ||= {}
+        cached = @cfunc_nogvl_trampolines[cfunc_type.c_func_name]
+        return cached if cached
+
+        func = declare_cfunc(cfunc_type)
+        param_types = cfunc_llvm_param_types(cfunc_type)
+        void_return = cfunc_type.return_type == :void
+        field_types = void_return ? param_types : param_types + [cfunc_type_to_llvm(cfunc_type.return_type)]
+        frame_type = LLVM::Struct(*field_types)
+
+        trampoline = @mod.functions.add("konpeito_nogvl_#{cfunc_type.c_func_name}", [ptr_type], ptr_type)
+        trampoline.linkage = :internal
+
+        # Separate builder so the caller's insertion point is untouched
+        tb = LLVM::Builder.new
+        tb.position_at_end(trampoline.basic_blocks.append("entry"))
+        frame = tb.bit_cast(trampoline.params[0], LLVM::Pointer(frame_type), "frame")
+        args = param_types.each_with_index.map do |type, i|
+          field = tb.gep2(frame_type, frame, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(i)], "arg_#{i}_ptr")
+          tb.load2(type, field, "arg_#{i}")
+        end
+        if void_return
+          tb.call(func, *args)
+        else
+          result = tb.call(func, *args, "result")
+          result_field = tb.gep2(frame_type, frame, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(param_types.size)], "result_ptr")
+          tb.store(result, result_field)
+        end
+        tb.ret(LLVM::Pointer(LLVM::Int8).null)
+
+        @cfunc_nogvl_trampolines[cfunc_type.c_func_name] = [trampoline, frame_type]
+      end
+
+      # void *rb_thread_call_without_gvl(void *(*func)(void *), void *data1,
+      #                                  rb_unblock_function_t *ubf, void *data2)
+      def declare_rb_thread_call_without_gvl
+        @rb_thread_call_without_gvl ||= @mod.functions["rb_thread_call_without_gvl"] || begin
+          callback_type = LLVM::Function([ptr_type], ptr_type)
+          @mod.functions.add("rb_thread_call_without_gvl",
+            [LLVM::Pointer(callback_type), ptr_type, ptr_type, ptr_type],
+            ptr_type)
+        end
+      end
+
       # Declare an external C function for @cfunc calls
       def declare_cfunc(cfunc_type)
         @declared_cfuncs ||= {}
         return @declared_cfuncs[cfunc_type.c_func_name] if @declared_cfuncs[cfunc_type.c_func_name]
 
-        # Convert types to LLVM types
-        param_types = cfunc_type.param_types.map { |t| cfunc_type_to_llvm(t) }
+        param_types = cfunc_llvm_param_types(cfunc_type)
         return_type = cfunc_type_to_llvm(cfunc_type.return_type)
 
         func = @mod.functions.add(cfunc_type.c_func_name, param_types, return_type)
@@ -13560,12 +14325,21 @@ module Konpeito
         func
       end
 
+      # LLVM parameter types of a cfunc as called from C
+      def cfunc_llvm_param_types(cfunc_type)
+        param_types = cfunc_type.param_types.flat_map do |t|
+          TypeChecker::Types::CFuncType.buffer_param?(t) ? [ptr_type, LLVM::Int64] : [cfunc_type_to_llvm(t)]
+        end
+        param_types << ptr_type if cfunc_type.ptr_len_return?  # int64_t *out_len
+        param_types
+      end
+
       # Convert CFuncType type symbol to LLVM type
       def cfunc_type_to_llvm(type_sym)
         case type_sym
         when :Float then LLVM::Double
         when :Integer then LLVM::Int64
-        when :String then ptr_type  # const char* for C functions
+        when :String, :ByteSlice then ptr_type  # const char* for C functions
         when :Bool then LLVM::Int1
         when :void then LLVM.Void
         else LLVM::Int64  # Default to VALUE for unknown types
@@ -13638,6 +14412,97 @@ module Konpeito
         end
       end
 
+      # Variable type tags accepted for each cfunc buffer parameter kind
+      CFUNC_BUFFER_ARG_TAGS = {
+        ByteBuffer: %i[byte_buffer],
+        ByteSlice: %i[byte_slice byte_buffer],
+        Slice: %i[slice_int64 slice_float64],
+        NativeArray: %i[native_array]
+      }.freeze
+
+      # Data pointer and length of a native buffer passed to a cfunc. Nothing
+      # is copied: the callee sees the buffer's own memory, which stays valid
+      # for the duration of the call.
+      def convert_to_cfunc_buffer_args(arg, expected_type, c_func_name, index)
+        value, type_tag = get_value_with_type(arg)
+        kind = TypeChecker::Types::CFuncType.buffer_kind(expected_type)
+        unless CFUNC_BUFFER_ARG_TAGS[kind].include?(type_tag)
+          raise "%a{cfunc} #{c_func_name}: argument #{index + 1} must be a #{expected_type}, got #{type_tag}"
+        end
+
+        # The callee reads the elements as the declared type: no reinterpreting
+        if (expected_element = TypeChecker::Types::CFuncType.buffer_element_type(expected_type))
+          element = cfunc_buffer_arg_element_type(arg, type_tag)
+          unless element == expected_element
+            raise "%a{cfunc} #{c_func_name}: argument #{index + 1} must be a #{expected_type}, " \
+                  "got #{kind}[#{element || "unknown"}]"
+          end
+        end
+
+        data_ptr, len_val = case type_tag
+        when :byte_buffer
+          # { i64 capacity, i64 length, ptr data }
+          struct_type = get_byte_buffer_struct
+          data_field = @builder.gep2(struct_type, value, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(2)], "cfunc_buf_data_field")
+          len_field = @builder.gep2(struct_type, value, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(1)], "cfunc_buf_len_field")
+          [@builder.load2(LLVM::Pointer(LLVM::Int8), data_field, "cfunc_buf_data"),
+           @builder.load2(LLVM::Int64, len_field, "cfunc_buf_len")]
+        when :byte_slice
+          # { ptr data, i64 length }
+          struct_type = get_byte_slice_struct
+          data_field = @builder.gep2(struct_type, value, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(0)], "cfunc_slice_data_field")
+          len_field = @builder.gep2(struct_type, value, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(1)], "cfunc_slice_len_field")
+          [@builder.load2(LLVM::Pointer(LLVM::Int8), data_field, "cfunc_slice_data"),
+           @builder.load2(LLVM::Int64, len_field, "cfunc_slice_len")]
+        when :slice_int64, :slice_float64
+          # { ptr elements, i64 size } - length is an element count
+          element_type = type_tag == :slice_int64 ? :Int64 : :Float64
+          struct_type = get_slice_struct(element_type)
+          data_field = @builder.gep2(struct_type, value, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(0)], "cfunc_slice_data_field")
+          size_field = @builder.gep2(struct_type, value, [LLVM::Int32.from_i(0), LLVM::Int32.from_i(1)], "cfunc_slice_size_field")
+          [@builder.load2(LLVM::Pointer(slice_element_llvm_type(element_type)), data_field, "cfunc_slice_data"),
+           @builder.load2(LLVM::Int64, size_field, "cfunc_slice_size")]
+        when :native_array
+          # Pointer is the value itself; length comes from the _len metadata
+          len_val = @variables["#{get_receiver_var_name(arg)}_len"]
+          len_val ||= @variables["#{arg.var.name}_len"] if arg.is_a?(HIR::LoadLocal)
+          unless len_val
+            raise "%a{cfunc} #{c_func_name}: argument #{index + 1} is a NativeArray whose length is not known here; " \
+                  "pass a local NativeArray variable"
+          end
+          [value, len_val]
+        end
+
+        [@builder.bit_cast(data_ptr, ptr_type, "cfunc_buf_ptr"), len_val]
+      end
+
+      # Element type (:Int64, :Float64 or a NativeClass name) of a Slice or
+      # NativeArray cfunc argument, or nil when it is not known
+      def cfunc_buffer_arg_element_type(arg, type_tag)
+        case type_tag
+        when :slice_int64 then :Int64
+        when :slice_float64 then :Float64
+        when :native_array
+          type = arg.type if arg.respond_to?(:type)
+          return nil unless type.is_a?(TypeChecker::Types::NativeArrayType)
+
+          element = type.element_type
+          element.is_a?(TypeChecker::Types::NativeClassType) ? element.name.to_sym : element
+        end
+      end
+
+      # C result and its type tag. Float and Integer results stay unboxed
+      # (:double / :i64) like numeric literals, so a cfunc result feeding
+      # arithmetic or another cfunc never allocates; convert_value boxes it
+      # only where it escapes to Ruby.
+      def cfunc_result_with_type(value, source_type)
+        case source_type
+        when :Float then [value, :double]
+        when :Integer then [value, :i64]
+        else [convert_from_cfunc_result(value, source_type), :value]
+        end
+      end
+
       # Convert C result to Ruby VALUE
       def convert_from_cfunc_result(value, source_type)
         case source_type
@@ -13724,17 +14589,17 @@ module Konpeito
         end
 
         # Call the C function
-        result = if method_sig.return_type == :void
+        result, result_type_tag = if method_sig.return_type == :void
           @builder.call(func, *call_args)
-          qnil
+          [qnil, :value]
         else
           raw_result = @builder.call(func, *call_args, "extern_result")
-          convert_from_cfunc_result(raw_result, method_sig.return_type)
+          cfunc_result_with_type(raw_result, method_sig.return_type)
         end
 
         if inst.result_var
           @variables[inst.result_var] = result
-          @variable_types[inst.result_var] = :value
+          @variable_types[inst.result_var] = result_type_tag
         end
 
         result
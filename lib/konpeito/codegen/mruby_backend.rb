@@ -780,19 +780,22 @@ module Konpeito
         when :Int64, :int, :long then "long"
         when :Void, :void then "void"
         when :String, :string then "const char*"
-        when :Pointer, :ptr then "void*"
+        when :Pointer, :ptr, :ByteSlice then "void*"
         else "double"
         end
 
-        params_c = cfunc_type.param_types.map do |pt|
+        params_c = cfunc_type.param_types.flat_map do |pt|
+          next ["void*", "int64_t"] if TypeChecker::Types::CFuncType.buffer_param?(pt)
+
           case pt
-          when :Float64, :float, :double then "double"
-          when :Int64, :int, :long then "long"
-          when :String, :string then "const char*"
-          when :Pointer, :ptr then "void*"
-          else "double"
+          when :Float64, :float, :double then ["double"]
+          when :Int64, :int, :long then ["long"]
+          when :String, :string then ["const char*"]
+          when :Pointer, :ptr then ["void*"]
+          else ["double"]
           end
         end
+        params_c << "int64_t*" if cfunc_type.ptr_len_return?
 
         lines << "extern #{return_c} #{cfunc_type.c_func_name}(#{params_c.join(', ')});"
         lines
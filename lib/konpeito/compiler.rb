@@ -389,7 +389,7 @@ module Konpeito
     def generate_cruby_extension(hir)
       log "Generating LLVM IR..."
 
-      # Detect if HIR uses JSON parse_as
+      # Detect if HIR uses JSON parse_as / generate_as
       uses_json_parse_as = hir_uses_json_parse_as?(hir)
       log "  - JSON parse_as detected" if uses_json_parse_as && verbose
 
@@ -512,7 +512,8 @@ module Konpeito
       hir.functions.any? do |func|
         func.body.any? do |bb|
           bb.instructions.any? do |instr|
-            instr.is_a?(HIR::JSONParseAs) || instr.is_a?(HIR::JSONParseArrayAs)
+            instr.is_a?(HIR::JSONParseAs) || instr.is_a?(HIR::JSONParseArrayAs) ||
+              instr.is_a?(HIR::JSONGenerateAs) || instr.is_a?(HIR::JSONGenerateArrayAs)
           end
         end
       end
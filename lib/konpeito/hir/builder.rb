@@ -1319,7 +1319,7 @@ module Konpeito
         end
 
         # Track ByteSlice assignments
-        if value.is_a?(ByteBufferSlice)
+        if value.is_a?(ByteBufferSlice) || (value.is_a?(CFuncCall) && value.cfunc_type.return_type == :ByteSlice)
           byte_slice_vars[name] = true
         end
 
@@ -1895,6 +1895,16 @@ module Konpeito
           return visit_konpeito_json_parse_array_as(typed_node)
         end
 
+        # Check for KonpeitoJSON.generate_as(native_obj) pattern
+        if konpeito_json_generate_as_call?(typed_node)
+          return visit_konpeito_json_generate_as(typed_node)
+        end
+
+        # Check for KonpeitoJSON.generate_array_as(native_array) pattern
+        if konpeito_json_generate_array_as_call?(typed_node)
+          return visit_konpeito_json_generate_array_as(typed_node)
+        end
+
         # Check for NativeString.from(str) pattern
         if native_string_from_call?(typed_node)
           return visit_native_string_from(typed_node)
@@ -2270,7 +2280,8 @@ module Konpeito
         block = nil
         block_child = typed_node.children.find { |c| c.node_type == :block }
         if block_child
-          block = visit_block_def(block_child)
+          shell_each_line = shell_each_line_call?(typed_node)
+          block = visit_block_def(block_child, byte_slice_params: shell_each_line, native_loop: shell_each_line)
         end
 
         # Handle &blk block argument reference (e.g., arr.map(&blk)) or
@@ -2824,6 +2835,9 @@ module Konpeito
         class_name = extract_class_name_from_receiver(receiver_child)
         return unless class_name
 
+        # Lowered by the backend, not dispatched
+        return if shell_each_line_call?(typed_node)
+
         # Only warn for modules that have cfunc methods (stdlib modules like Raylib, Clay)
         return unless @rbs_loader.has_cfunc_methods?(class_name)
 
@@ -3355,6 +3369,80 @@ module Konpeito
         inst
       end
 
+      # Check if this is a KonpeitoJSON.generate_as(obj) call on a NativeClass instance
+      # Other receivers fall through to the runtime KonpeitoJSON.generate_as
+      def konpeito_json_generate_as_call?(typed_node)
+        return false unless typed_node.node.name.to_s == "generate_as"
+
+        receiver_child = typed_node.children.first
+        return false unless receiver_child&.node_type == :constant_read
+        return false unless receiver_child.node.name.to_s == "KonpeitoJSON"
+
+        !json_generate_arg_class(typed_node).nil?
+      end
+
+      # Handle KonpeitoJSON.generate_as(native_obj)
+      def visit_konpeito_json_generate_as(typed_node)
+        args_child = typed_node.children.find { |c| c.node_type == :arguments }
+        target_class_type = json_generate_arg_class(typed_node)
+        object_expr = visit(args_child.children[0])
+
+        inst = JSONGenerateAs.new(
+          object_expr: object_expr,
+          target_class: target_class_type,
+          result_var: new_temp_var
+        )
+        emit(inst)
+        inst
+      end
+
+      # NativeClass type of the single generate_as argument, or nil
+      def json_generate_arg_class(typed_node)
+        args_child = typed_node.children.find { |c| c.node_type == :arguments }
+        return nil unless args_child && args_child.children.length == 1
+
+        resolve_native_class_type_from_receiver(args_child.children[0])
+      end
+
+      # Check if this is a KonpeitoJSON.generate_array_as(arr) call on a NativeArray[NativeClass]
+      def konpeito_json_generate_array_as_call?(typed_node)
+        return false unless typed_node.node.name.to_s == "generate_array_as"
+
+        receiver_child = typed_node.children.first
+        return false unless receiver_child&.node_type == :constant_read
+        return false unless receiver_child.node.name.to_s == "KonpeitoJSON"
+
+        !json_generate_array_arg_class(typed_node).nil?
+      end
+
+      # Handle KonpeitoJSON.generate_array_as(native_array)
+      def visit_konpeito_json_generate_array_as(typed_node)
+        args_child = typed_node.children.find { |c| c.node_type == :arguments }
+        element_class_type = json_generate_array_arg_class(typed_node)
+        array_expr = visit(args_child.children[0])
+
+        inst = JSONGenerateArrayAs.new(
+          array_expr: array_expr,
+          element_class: element_class_type,
+          result_var: new_temp_var
+        )
+        emit(inst)
+        inst
+      end
+
+      # Element NativeClass type of the single generate_array_as argument, or nil
+      # Only local NativeArray variables are supported (their length is tracked)
+      def json_generate_array_arg_class(typed_node)
+        args_child = typed_node.children.find { |c| c.node_type == :arguments }
+        return nil unless args_child && args_child.children.length == 1
+
+        array_child = args_child.children[0]
+        return nil unless array_child.node_type == :local_variable_read
+
+        element_type = @native_array_vars[array_child.node.name.to_s]
+        element_type.is_a?(TypeChecker::Types::NativeClassType) ? element_type : nil
+      end
+
       # Check if this is a NativeString.from(str) call
       def native_string_from_call?(typed_node)
         return false unless typed_node.node.name.to_s == "from"
@@ -6041,7 +6129,17 @@ module Konpeito
         inst
       end
 
-      def visit_block_def(typed_node)
+      # KonpeitoShell.each_line(path) { |line| ... } - the block parameter is
+      # a ByteSlice view into the mapped file (see generate_inline_shell_each_line)
+      def shell_each_line_call?(typed_node)
+        typed_node.node.name.to_s == "each_line" &&
+          extract_class_name_from_receiver(typed_node.children.first) == :KonpeitoShell
+      end
+
+      # @param byte_slice_params [Boolean] Bind the block parameters as ByteSlices
+      # @param native_loop [Boolean] The backend lowers the block into a loop:
+      #   next/break in the body jump to the BlockDef's next_label/break_label
+      def visit_block_def(typed_node, byte_slice_params: false, native_loop: false)
         params = []
         if typed_node.node.parameters
           if typed_node.node.parameters.is_a?(Prism::NumberedParametersNode)
@@ -6076,11 +6174,24 @@ module Konpeito
         # Use a simple wrapper class that responds to body
         @current_function = BlockBodyCollector.new(block_body)
 
+        saved_byte_slice_vars = byte_slice_vars.dup
+        if byte_slice_params
+          params = params.map { |param| Param.new(name: param.name, type: TypeChecker::Types::BYTESLICE) }
+          params.each { |param| byte_slice_vars[param.name] = true }
+        end
+
         # Add block parameters to local variables
         params.each do |param|
           @local_vars[param.name] = LocalVar.new(name: param.name, type: param.type)
         end
 
+        next_label = break_label = nil
+        if native_loop
+          next_label = "#{entry.label}_next"
+          break_label = "#{entry.label}_break"
+          @loop_stack.push({ cond_label: next_label, exit_label: break_label, break_val_var: nil })
+        end
+
         # Compile block body
         body_result = nil
         typed_node.children.each do |child|
@@ -6091,6 +6202,8 @@ module Konpeito
           body_result = visit(child)
         end
 
+        @loop_stack.pop if native_loop
+
         # Collect all blocks generated for this block body
         body_blocks = @current_function.body
 
@@ -6100,10 +6213,12 @@ module Konpeito
         # Restore outer scope
         @local_vars = saved_local_vars
         @native_class_vars = saved_native_class_vars
+        @byte_slice_vars = saved_byte_slice_vars
         @current_block = saved_current_block
         @current_function = saved_function
 
-        BlockDef.new(params: params, body: body_blocks, captures: captures)
+        BlockDef.new(params: params, body: body_blocks, captures: captures,
+                     next_label: next_label, break_label: break_label)
       end
 
       # Lambda literal: ->(x) { x * 2 }
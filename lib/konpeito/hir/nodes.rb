@@ -535,14 +535,18 @@ module Konpeito
 
     # Block/Lambda definition
     class BlockDef < Node
-      attr_reader :params, :body, :captures, :is_lambda
+      attr_reader :params, :body, :captures, :is_lambda, :next_label, :break_label
 
-      def initialize(params: [], body: [], captures: [], is_lambda: false)
+      def initialize(params: [], body: [], captures: [], is_lambda: false, next_label: nil, break_label: nil)
         super(type: TypeChecker::Types::ClassInstance.new(:Proc))
         @params = params
         @body = body  # Array of BasicBlock
         @captures = captures  # Array of Capture objects
         @is_lambda = is_lambda
+        # Jump targets of next/break when the backend lowers the block into a
+        # native loop (labels outside body; nil for ordinary blocks)
+        @next_label = next_label
+        @break_label = break_label
       end
     end
 
@@ -2152,6 +2156,7 @@ module Konpeito
         when :Integer then TypeChecker::Types::INTEGER
         when :String then TypeChecker::Types::STRING
         when :Bool then TypeChecker::Types::BOOL
+        when :ByteSlice then TypeChecker::Types::BYTESLICE
         when :void then TypeChecker::Types::NIL
         else TypeChecker::Types::UNTYPED
         end
@@ -2345,6 +2350,37 @@ module Konpeito
       end
     end
 
+    # Serialize a NativeClass instance directly to a JSON String
+    # KonpeitoJSON.generate_as(user) → String
+    # Specialized per class: keys are precomputed fragments, fields are read unboxed
+    class JSONGenerateAs < Instruction
+      attr_reader :object_expr, :target_class
+
+      # @param object_expr [Instruction] HIR expression for the NativeClass instance
+      # @param target_class [NativeClassType] NativeClass type of the instance
+      # @param result_var [String, nil] Result variable name
+      def initialize(object_expr:, target_class:, result_var: nil)
+        super(type: TypeChecker::Types::STRING, result_var: result_var)
+        @object_expr = object_expr
+        @target_class = target_class
+      end
+    end
+
+    # Serialize a NativeArray[NativeClass] to a JSON array String
+    # KonpeitoJSON.generate_array_as(users) → String
+    class JSONGenerateArrayAs < Instruction
+      attr_reader :array_expr, :element_class
+
+      # @param array_expr [Instruction] HIR expression for the NativeArray
+      # @param element_class [NativeClassType] Element NativeClass type
+      # @param result_var [String, nil] Result variable name
+      def initialize(array_expr:, element_class:, result_var: nil)
+        super(type: TypeChecker::Types::STRING, result_var: result_var)
+        @array_expr = array_expr
+        @element_class = element_class
+      end
+    end
+
     # ========================================
     # NativeHash operations
     # Generic hash with Robin Hood hashing
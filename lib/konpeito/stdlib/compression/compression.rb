@@ -14,6 +14,9 @@
 #   fast = KonpeitoCompression.deflate(data, KonpeitoCompression::BEST_SPEED)
 #   small = KonpeitoCompression.deflate(data, KonpeitoCompression::BEST_COMPRESSION)
 #
+#   # Large inputs: compress 128KB blocks on all cores (still one gzip stream)
+#   archive = KonpeitoCompression.gzip_parallel(export, level: 6, threads: 8)
+#
 #   # Raw deflate (for custom protocols, no header overhead)
 #   compressed = KonpeitoCompression.deflate("Hello", nil)
 #   original = KonpeitoCompression.inflate(compressed)
@@ -21,6 +24,23 @@
 #   # Zlib format (includes checksum, good for data integrity)
 #   compressed = KonpeitoCompression.zlib_compress("Hello")
 #   original = KonpeitoCompression.zlib_decompress(compressed, nil)
+#
+#   # zstd / lz4 (only when built against libzstd / liblz4; absent in the fallback)
+#   packed = KonpeitoCompression.zstd_compress(payload, level: 3)
+#   dict = KonpeitoCompression::ZstdDictionary.new(
+#     KonpeitoCompression.zstd_train_dictionary(sample_records))
+#   small = KonpeitoCompression.zstd_compress(record, dict: dict)
+#   record = KonpeitoCompression.zstd_decompress(small, dict: dict)
+#   fast = KonpeitoCompression.lz4_compress(payload)
+#
+#   # Streaming gzip (constant memory, path or IO)
+#   writer = KonpeitoCompression::GzipWriter.new("out.gz", level: 6)
+#   writer << chunk1 << chunk2
+#   writer.close
+#
+#   reader = KonpeitoCompression::GzipReader.new("out.gz")
+#   reader.each_chunk { |chunk| process(chunk) }
+#   reader.close
 
 # Try to load the native extension
 begin
@@ -43,6 +63,14 @@ rescue LoadError => e
         Zlib.gunzip(data)
       end
 
+      # Single-threaded here: only the native extension splits the work
+      def gzip_parallel(data, level: nil, threads: nil)
+        raise ArgumentError, "threads must be positive" if threads && threads < 1
+        level ||= Zlib::DEFAULT_COMPRESSION
+        raise ArgumentError, "Compression level must be 0-9" unless level == Zlib::DEFAULT_COMPRESSION || (0..9).cover?(level)
+        Zlib.gzip(data, level: level)
+      end
+
       def deflate(data, level = nil)
         level ||= Zlib::DEFAULT_COMPRESSION
         deflater = Zlib::Deflate.new(level, -Zlib::MAX_WBITS)
@@ -66,6 +94,136 @@ rescue LoadError => e
         Zlib.inflate(data)
       end
     end
+
+    STREAM_CHUNK_SIZE = 64 * 1024
+
+    class GzipWriter
+      def initialize(dest, level: nil)
+        level ||= Zlib::DEFAULT_COMPRESSION
+        raise ArgumentError, "Compression level must be 0-9" unless level == Zlib::DEFAULT_COMPRESSION || (0..9).cover?(level)
+        @owns_io = dest.is_a?(String)
+        @io = @owns_io ? File.open(dest, "wb") : dest
+        @deflate = Zlib::Deflate.new(level, Zlib::MAX_WBITS + 16)
+        @finished = false
+        @closed = false
+      end
+
+      def write(data)
+        check_open
+        out = @deflate.deflate(data)
+        @io.write(out) unless out.empty?
+        data.bytesize
+      end
+
+      def <<(data)
+        write(data)
+        self
+      end
+
+      def flush
+        check_open
+        out = @deflate.flush(Zlib::SYNC_FLUSH)
+        @io.write(out) unless out.empty?
+        self
+      end
+
+      def finish
+        check_open
+        @io.write(@deflate.finish)
+        @deflate.close
+        @finished = true
+        @io
+      end
+
+      def close
+        return nil if @closed
+        finish unless @finished
+        @closed = true
+        @io.close if @owns_io
+        nil
+      end
+
+      private
+
+      def check_open
+        raise IOError, "closed GzipWriter" if @closed || @finished
+      end
+    end
+
+    class GzipReader
+      def initialize(source)
+        @owns_io = source.is_a?(String)
+        @io = @owns_io ? File.open(source, "rb") : source
+        @inflate = Zlib::Inflate.new(Zlib::MAX_WBITS + 32)
+        @buffer = "".b
+        @eof = false
+        @closed = false
+      end
+
+      def read(length = nil)
+        check_open
+        if length.nil?
+          fill until @eof
+          return take(@buffer.bytesize)
+        end
+        raise ArgumentError, "negative length #{length} given" if length < 0
+        return "".b if length == 0
+        fill while @buffer.bytesize < length && !@eof
+        @buffer.empty? ? nil : take(length)
+      end
+
+      def each_chunk
+        return enum_for(:each_chunk) unless block_given?
+        while (chunk = read(STREAM_CHUNK_SIZE))
+          yield chunk
+        end
+        nil
+      end
+
+      def eof?
+        check_open
+        fill while @buffer.empty? && !@eof
+        @buffer.empty?
+      end
+
+      def close
+        return nil if @closed
+        @closed = true
+        @io.close if @owns_io
+        nil
+      end
+
+      private
+
+      def check_open
+        raise IOError, "closed GzipReader" if @closed
+      end
+
+      def take(length)
+        @buffer.slice!(0, length)
+      end
+
+      # Decompress the next input chunk; concatenated members are one stream
+      def fill
+        input = @io.read(STREAM_CHUNK_SIZE)
+        if input.nil? || input.empty?
+          raise "Decompression failed: unexpected end of gzip data" if @inflate
+          @eof = true
+          return
+        end
+        until input.empty?
+          @inflate ||= Zlib::Inflate.new(Zlib::MAX_WBITS + 32)
+          consumed = @inflate.total_in
+          @buffer << @inflate.inflate(input)
+          break unless @inflate.finished?
+          input = input.byteslice((@inflate.total_in - consumed)..)
+          @inflate.close
+          @inflate = nil
+        end
+      rescue Zlib::Error => e
+        raise "Decompression failed: #{e.message}"
+      end
+    end
   end
 
   warn "KonpeitoCompression: Native extension not available, using Zlib fallback (#{e.message})"
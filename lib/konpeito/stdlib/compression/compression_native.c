@@ -6,150 +6,290 @@
  */
 
 #include <ruby.h>
+#include <ruby/thread.h>
 #include <zlib.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#ifdef HAVE_ZSTD_H
+#include <zstd.h>
+#include <zdict.h>
+#endif
+#ifdef HAVE_LZ4FRAME_H
+#include <lz4frame.h>
+#endif
 
 /* Default chunk size for compression */
 #define CHUNK_SIZE 16384
 
 /*
- * Compress data using gzip format
- *
- * @param data [String] Data to compress
- * @return [String] Gzip-compressed data
- * @raise [RuntimeError] if compression fails
+ * Inputs at least this large are (de)compressed without the GVL, so other
+ * Ruby threads keep running. The String is pinned with a frozen snapshot
+ * for the duration; below the threshold the handoff costs more than it
+ * frees.
  */
-VALUE konpeito_compression_gzip(VALUE self, VALUE data) {
-    Check_Type(data, T_STRING);
+#define COMPRESSION_NOGVL_MIN_SIZE (32 * 1024)
 
-    const unsigned char *input = (const unsigned char *)RSTRING_PTR(data);
-    size_t input_len = RSTRING_LEN(data);
+/* Frozen snapshot for inputs that will be read without the GVL */
+static VALUE compression_pin(VALUE data) {
+    return RSTRING_LEN(data) >= COMPRESSION_NOGVL_MIN_SIZE ? rb_str_new_frozen(data) : data;
+}
 
-    /* Allocate output buffer (worst case: input size + overhead) */
-    uLongf output_len = compressBound(input_len) + 18; /* gzip header/footer */
-    unsigned char *output = malloc(output_len);
-    if (!output) {
-        rb_raise(rb_eNoMemError, "Failed to allocate compression buffer");
-        return Qnil;
+static void compression_call(void *(*fn)(void *), void *job, size_t input_len) {
+    if (input_len >= COMPRESSION_NOGVL_MIN_SIZE) {
+        rb_thread_call_without_gvl(fn, job, NULL, NULL);
+    } else {
+        fn(job);
     }
+}
 
-    /* Initialize zlib stream for gzip */
+/*
+ * compression_call on a stream object, with *in_use set for the duration.
+ * The flag is cleared in an ensure: the interrupt check that follows a
+ * no-GVL call can raise, which would otherwise leave the stream stuck.
+ */
+typedef struct {
+    void *(*fn)(void *);
+    void *job;
+    size_t input_len;
+    int *in_use;
+} compression_stream_call_t;
+
+static VALUE compression_stream_call_body(VALUE arg) {
+    compression_stream_call_t *call = (compression_stream_call_t *)arg;
+    compression_call(call->fn, call->job, call->input_len);
+    return Qnil;
+}
+
+static VALUE compression_stream_call_ensure(VALUE arg) {
+    compression_stream_call_t *call = (compression_stream_call_t *)arg;
+    *call->in_use = 0;
+    return Qnil;
+}
+
+static void compression_stream_call(int *in_use, void *(*fn)(void *), void *job, size_t input_len) {
+    compression_stream_call_t call = { fn, job, input_len, in_use };
+    *in_use = 1;
+    rb_ensure(compression_stream_call_body, (VALUE)&call, compression_stream_call_ensure, (VALUE)&call);
+}
+
+/* Where a zlib job stopped; raised once the GVL is held again */
+enum {
+    ZLIB_JOB_OK = 0,
+    ZLIB_JOB_INIT_FAILED,
+    ZLIB_JOB_FAILED,
+    ZLIB_JOB_NOMEM,
+    ZLIB_JOB_TOO_LARGE,
+};
+
+/*
+ * One-shot deflate/inflate over a whole String. The run functions touch
+ * only zlib and malloc, so they can run without the GVL.
+ */
+typedef struct {
+    const unsigned char *input;
+    size_t input_len;
+    int level;
+    int window_bits;
+    size_t max_output;      /* inflate only */
+    unsigned char *output;  /* malloc'd, freed by zlib_job_ensure */
+    size_t output_len;
+    int status;
+    const char *msg;        /* zlib's static message, if any */
+} zlib_job_t;
+
+static void *zlib_deflate_run(void *arg) {
+    zlib_job_t *job = (zlib_job_t *)arg;
     z_stream stream;
     memset(&stream, 0, sizeof(stream));
 
-    /* windowBits 15 + 16 = gzip format */
-    int ret = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
-                           15 + 16, 8, Z_DEFAULT_STRATEGY);
+    int ret = deflateInit2(&stream, job->level, Z_DEFLATED,
+                           job->window_bits, 8, Z_DEFAULT_STRATEGY);
     if (ret != Z_OK) {
-        free(output);
-        rb_raise(rb_eRuntimeError, "Failed to initialize compression: %s",
-                 stream.msg ? stream.msg : "unknown error");
-        return Qnil;
+        job->status = ZLIB_JOB_INIT_FAILED;
+        job->msg = stream.msg;
+        return NULL;
     }
 
-    stream.next_in = (Bytef *)input;
-    stream.avail_in = (uInt)input_len;
-    stream.next_out = output;
-    stream.avail_out = (uInt)output_len;
+    /* Worst case: input size + overhead (gzip header/footer) */
+    size_t output_size = deflateBound(&stream, (uLong)job->input_len) + 18;
+    job->output = malloc(output_size);
+    if (!job->output) {
+        deflateEnd(&stream);
+        job->status = ZLIB_JOB_NOMEM;
+        return NULL;
+    }
+
+    stream.next_in = (Bytef *)job->input;
+    stream.avail_in = (uInt)job->input_len;
+    stream.next_out = job->output;
+    stream.avail_out = (uInt)output_size;
 
     ret = deflate(&stream, Z_FINISH);
     if (ret != Z_STREAM_END) {
-        deflateEnd(&stream);
-        free(output);
-        rb_raise(rb_eRuntimeError, "Compression failed: %s",
-                 stream.msg ? stream.msg : "unknown error");
-        return Qnil;
+        job->status = ZLIB_JOB_FAILED;
+        job->msg = stream.msg;
     }
-
-    size_t compressed_len = stream.total_out;
+    job->output_len = stream.total_out;
     deflateEnd(&stream);
-
-    VALUE result = rb_str_new((const char *)output, compressed_len);
-    free(output);
-
-    return result;
+    return NULL;
 }
 
-/*
- * Decompress gzip data
- *
- * @param data [String] Gzip-compressed data
- * @return [String] Decompressed data
- * @raise [RuntimeError] if decompression fails
- */
-VALUE konpeito_compression_gunzip(VALUE self, VALUE data) {
-    Check_Type(data, T_STRING);
-
-    const unsigned char *input = (const unsigned char *)RSTRING_PTR(data);
-    size_t input_len = RSTRING_LEN(data);
-
-    /* Start with a reasonable output buffer size */
-    size_t output_size = input_len * 4;
-    if (output_size < CHUNK_SIZE) output_size = CHUNK_SIZE;
-    unsigned char *output = malloc(output_size);
-    if (!output) {
-        rb_raise(rb_eNoMemError, "Failed to allocate decompression buffer");
-        return Qnil;
-    }
-
-    /* Initialize zlib stream for gzip */
+static void *zlib_inflate_run(void *arg) {
+    zlib_job_t *job = (zlib_job_t *)arg;
     z_stream stream;
     memset(&stream, 0, sizeof(stream));
 
-    /* windowBits 15 + 32 = auto-detect gzip/zlib */
-    int ret = inflateInit2(&stream, 15 + 32);
+    int ret = inflateInit2(&stream, job->window_bits);
     if (ret != Z_OK) {
-        free(output);
-        rb_raise(rb_eRuntimeError, "Failed to initialize decompression: %s",
-                 stream.msg ? stream.msg : "unknown error");
-        return Qnil;
+        job->status = ZLIB_JOB_INIT_FAILED;
+        job->msg = stream.msg;
+        return NULL;
+    }
+
+    /* Start with a reasonable output buffer size */
+    size_t output_size = job->input_len * 4;
+    if (output_size < CHUNK_SIZE) output_size = CHUNK_SIZE;
+    if (output_size > job->max_output) output_size = job->max_output;
+    job->output = malloc(output_size > 0 ? output_size : 1);
+    if (!job->output) {
+        inflateEnd(&stream);
+        job->status = ZLIB_JOB_NOMEM;
+        return NULL;
     }
 
-    stream.next_in = (Bytef *)input;
-    stream.avail_in = (uInt)input_len;
+    stream.next_in = (Bytef *)job->input;
+    stream.avail_in = (uInt)job->input_len;
 
     size_t total_out = 0;
 
     do {
         /* Expand buffer if needed */
         if (total_out >= output_size) {
+            if (output_size >= job->max_output) {
+                job->status = ZLIB_JOB_TOO_LARGE;
+                break;
+            }
             output_size *= 2;
-            unsigned char *new_output = realloc(output, output_size);
+            if (output_size > job->max_output) output_size = job->max_output;
+            unsigned char *new_output = realloc(job->output, output_size);
             if (!new_output) {
-                inflateEnd(&stream);
-                free(output);
-                rb_raise(rb_eNoMemError, "Failed to expand decompression buffer");
-                return Qnil;
+                job->status = ZLIB_JOB_NOMEM;
+                break;
             }
-            output = new_output;
+            job->output = new_output;
         }
 
-        stream.next_out = output + total_out;
+        stream.next_out = job->output + total_out;
         stream.avail_out = (uInt)(output_size - total_out);
 
         ret = inflate(&stream, Z_NO_FLUSH);
 
         if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR) {
-            inflateEnd(&stream);
-            free(output);
-            rb_raise(rb_eRuntimeError, "Decompression failed: %s",
-                     stream.msg ? stream.msg : "data error");
-            return Qnil;
+            job->status = ZLIB_JOB_FAILED;
+            job->msg = stream.msg ? stream.msg : "data error";
+            break;
+        }
+        /* Input exhausted before the end of the stream */
+        if (ret == Z_BUF_ERROR && stream.avail_in == 0) {
+            job->status = ZLIB_JOB_FAILED;
+            job->msg = "unexpected end of data";
+            break;
         }
 
         total_out = stream.total_out;
 
     } while (ret != Z_STREAM_END);
 
+    job->output_len = total_out;
     inflateEnd(&stream);
+    return NULL;
+}
+
+/* Raise for a failed job, or copy its output into a String */
+static VALUE zlib_job_result(zlib_job_t *job, int inflating) {
+    if (job->status == ZLIB_JOB_OK) {
+        return rb_str_new((const char *)job->output, job->output_len);
+    }
+
+    const char *msg = job->msg ? job->msg : "unknown error";
+    switch (job->status) {
+    case ZLIB_JOB_NOMEM:
+        rb_raise(rb_eNoMemError, "Failed to allocate %s buffer", inflating ? "decompression" : "compression");
+    case ZLIB_JOB_TOO_LARGE:
+        rb_raise(rb_eRuntimeError, "Decompressed data exceeds maximum size");
+    case ZLIB_JOB_INIT_FAILED:
+        rb_raise(rb_eRuntimeError, "Failed to initialize %s: %s", inflating ? "decompression" : "compression", msg);
+    default:
+        rb_raise(rb_eRuntimeError, "%s failed: %s", inflating ? "Decompression" : "Compression", msg);
+    }
+    return Qnil;
+}
 
-    VALUE result = rb_str_new((const char *)output, total_out);
-    free(output);
+typedef struct {
+    zlib_job_t job;
+    int inflating;
+} zlib_job_call_t;
 
+/* Run the job and build its result; the output is freed by the ensure even if either raises */
+static VALUE zlib_job_body(VALUE arg) {
+    zlib_job_call_t *call = (zlib_job_call_t *)arg;
+    compression_call(call->inflating ? zlib_inflate_run : zlib_deflate_run, &call->job, call->job.input_len);
+    return zlib_job_result(&call->job, call->inflating);
+}
+
+static VALUE zlib_job_ensure(VALUE arg) {
+    zlib_job_call_t *call = (zlib_job_call_t *)arg;
+    free(call->job.output);
+    return Qnil;
+}
+
+static VALUE zlib_job_perform(VALUE data, int level, int window_bits, size_t max_output, int inflating) {
+    Check_Type(data, T_STRING);
+    VALUE input = compression_pin(data);
+
+    zlib_job_call_t call;
+    memset(&call, 0, sizeof(call));
+    call.job.input = (const unsigned char *)RSTRING_PTR(input);
+    call.job.input_len = RSTRING_LEN(input);
+    call.job.level = level;
+    call.job.window_bits = window_bits;
+    call.job.max_output = max_output;
+    call.inflating = inflating;
+
+    VALUE result = rb_ensure(zlib_job_body, (VALUE)&call, zlib_job_ensure, (VALUE)&call);
+    RB_GC_GUARD(input);
     return result;
 }
 
+/*
+ * Compress data using gzip format
+ *
+ * @param data [String] Data to compress
+ * @return [String] Gzip-compressed data
+ * @raise [RuntimeError] if compression fails
+ */
+VALUE konpeito_compression_gzip(VALUE self, VALUE data) {
+    /* windowBits 15 + 16 = gzip format */
+    return zlib_job_perform(data, Z_DEFAULT_COMPRESSION, 15 + 16, 0, 0);
+}
+
+/*
+ * Decompress gzip data
+ *
+ * @param data [String] Gzip-compressed data
+ * @return [String] Decompressed data
+ * @raise [RuntimeError] if decompression fails
+ */
+VALUE konpeito_compression_gunzip(VALUE self, VALUE data) {
+    /* windowBits 15 + 32 = auto-detect gzip/zlib */
+    return zlib_job_perform(data, 0, 15 + 32, SIZE_MAX, 1);
+}
+
 /*
  * Compress data using deflate (raw zlib format, no header)
  *
@@ -160,9 +300,6 @@ VALUE konpeito_compression_gunzip(VALUE self, VALUE data) {
  */
 VALUE konpeito_compression_deflate(VALUE self, VALUE data, VALUE level) {
     Check_Type(data, T_STRING);
-
-    const unsigned char *input = (const unsigned char *)RSTRING_PTR(data);
-    size_t input_len = RSTRING_LEN(data);
     int compression_level = NIL_P(level) ? Z_DEFAULT_COMPRESSION : NUM2INT(level);
 
     if (compression_level < 0 || compression_level > 9) {
@@ -172,226 +309,1375 @@ VALUE konpeito_compression_deflate(VALUE self, VALUE data, VALUE level) {
         }
     }
 
-    /* Allocate output buffer */
-    uLongf output_len = compressBound(input_len);
-    unsigned char *output = malloc(output_len);
-    if (!output) {
-        rb_raise(rb_eNoMemError, "Failed to allocate compression buffer");
-        return Qnil;
+    /* windowBits -15 = raw deflate (no zlib header) */
+    return zlib_job_perform(data, compression_level, -15, 0, 0);
+}
+
+/*
+ * Decompress deflate data (raw zlib format, no header)
+ *
+ * @param data [String] Deflate-compressed data
+ * @return [String] Decompressed data
+ * @raise [RuntimeError] if decompression fails
+ */
+VALUE konpeito_compression_inflate(VALUE self, VALUE data) {
+    /* windowBits -15 = raw inflate (no zlib header) */
+    return zlib_job_perform(data, 0, -15, SIZE_MAX, 1);
+}
+
+/*
+ * Compress data using zlib format (with header)
+ *
+ * @param data [String] Data to compress
+ * @return [String] Zlib-compressed data
+ * @raise [RuntimeError] if compression fails
+ */
+VALUE konpeito_compression_zlib_compress(VALUE self, VALUE data) {
+    /* windowBits 15 = zlib format, same stream as compress() */
+    return zlib_job_perform(data, Z_DEFAULT_COMPRESSION, 15, 0, 0);
+}
+
+/*
+ * Decompress zlib data (with header)
+ *
+ * @param data [String] Zlib-compressed data
+ * @param max_size [Integer] Maximum decompressed size (for safety)
+ * @return [String] Decompressed data
+ * @raise [RuntimeError] if decompression fails
+ */
+VALUE konpeito_compression_zlib_decompress(VALUE self, VALUE data, VALUE max_size) {
+    size_t max_output = NIL_P(max_size) ? 100 * 1024 * 1024 : (size_t)NUM2LONG(max_size); /* 100MB default */
+    return zlib_job_perform(data, 0, 15, max_output, 1);
+}
+
+/*
+ * Streaming gzip
+ *
+ * GzipWriter and GzipReader keep one z_stream across calls and move data
+ * through a fixed STREAM_CHUNK_SIZE buffer, so arbitrarily large inputs
+ * are (de)compressed in constant memory. The destination/source is a file
+ * path (opened and closed by the stream) or any object responding to
+ * write / read.
+ */
+
+#define STREAM_CHUNK_SIZE (64 * 1024)
+
+/* zlib counts in uInt: feed larger Strings in slices of this size */
+#define STREAM_MAX_SLICE (1U << 30)
+
+/* A single deflate()/inflate() call on a stream, for compression_call */
+typedef struct {
+    z_stream *stream;
+    int flush;
+    int ret;
+} zlib_step_t;
+
+static void *zlib_deflate_step(void *arg) {
+    zlib_step_t *step = (zlib_step_t *)arg;
+    step->ret = deflate(step->stream, step->flush);
+    return NULL;
+}
+
+static void *zlib_inflate_step(void *arg) {
+    zlib_step_t *step = (zlib_step_t *)arg;
+    step->ret = inflate(step->stream, step->flush);
+    return NULL;
+}
+
+static ID id_write;
+static ID id_read;
+static ID id_level;
+static ID id_threads;
+
+static VALUE stream_open_io(VALUE dest, const char *mode, int *owns_io) {
+    if (RB_TYPE_P(dest, T_STRING)) {
+        *owns_io = 1;
+        return rb_file_open_str(dest, mode);
+    }
+    *owns_io = 0;
+    return dest;
+}
+
+static int compression_level_arg(VALUE level) {
+    int compression_level = NIL_P(level) ? Z_DEFAULT_COMPRESSION : NUM2INT(level);
+    if ((compression_level < 0 || compression_level > 9) && compression_level != Z_DEFAULT_COMPRESSION) {
+        rb_raise(rb_eArgError, "Compression level must be 0-9");
     }
+    return compression_level;
+}
 
-    /* Initialize zlib stream for raw deflate */
+typedef struct {
     z_stream stream;
-    memset(&stream, 0, sizeof(stream));
+    VALUE io;
+    VALUE out;          /* output chunk, replaced once handed to the IO */
+    int owns_io;
+    int initialized;    /* deflateInit2 succeeded */
+    int finished;       /* Z_FINISH written */
+    int closed;
+    int in_use;         /* a thread is inside deflate without the GVL */
+} gzip_writer_t;
+
+static void gzip_writer_mark(void *ptr) {
+    gzip_writer_t *gw = (gzip_writer_t *)ptr;
+    rb_gc_mark(gw->io);
+    rb_gc_mark(gw->out);
+}
 
-    /* windowBits -15 = raw deflate (no zlib header) */
-    int ret = deflateInit2(&stream, compression_level, Z_DEFLATED,
-                           -15, 8, Z_DEFAULT_STRATEGY);
-    if (ret != Z_OK) {
-        free(output);
-        rb_raise(rb_eRuntimeError, "Failed to initialize compression: %s",
-                 stream.msg ? stream.msg : "unknown error");
-        return Qnil;
+static void gzip_writer_free(void *ptr) {
+    gzip_writer_t *gw = (gzip_writer_t *)ptr;
+    if (gw->initialized) {
+        deflateEnd(&gw->stream);
     }
+    ruby_xfree(gw);
+}
 
-    stream.next_in = (Bytef *)input;
-    stream.avail_in = (uInt)input_len;
-    stream.next_out = output;
-    stream.avail_out = (uInt)output_len;
+static const rb_data_type_t gzip_writer_type = {
+    "KonpeitoCompression::GzipWriter",
+    { gzip_writer_mark, gzip_writer_free, NULL, },
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE gzip_writer_alloc(VALUE klass) {
+    gzip_writer_t *gw;
+    VALUE obj = TypedData_Make_Struct(klass, gzip_writer_t, &gzip_writer_type, gw);
+    gw->io = Qnil;
+    gw->out = Qnil;
+    return obj;
+}
 
-    ret = deflate(&stream, Z_FINISH);
-    if (ret != Z_STREAM_END) {
-        deflateEnd(&stream);
-        free(output);
-        rb_raise(rb_eRuntimeError, "Compression failed: %s",
-                 stream.msg ? stream.msg : "unknown error");
-        return Qnil;
+static gzip_writer_t *gzip_writer_get(VALUE self) {
+    gzip_writer_t *gw;
+    TypedData_Get_Struct(self, gzip_writer_t, &gzip_writer_type, gw);
+    if (!gw->initialized) {
+        rb_raise(rb_eRuntimeError, "uninitialized GzipWriter");
+    }
+    if (gw->closed || gw->finished) {
+        rb_raise(rb_eIOError, "closed GzipWriter");
     }
+    if (gw->in_use) {
+        rb_raise(rb_eRuntimeError, "GzipWriter is in use by another thread");
+    }
+    return gw;
+}
 
-    size_t compressed_len = stream.total_out;
-    deflateEnd(&stream);
+/* Run deflate over the pending input, handing every full chunk to the IO */
+static void gzip_writer_run(gzip_writer_t *gw, int flush) {
+    int ret;
+    do {
+        rb_str_modify_expand(gw->out, STREAM_CHUNK_SIZE);
+        gw->stream.next_out = (Bytef *)RSTRING_PTR(gw->out);
+        gw->stream.avail_out = STREAM_CHUNK_SIZE;
+
+        zlib_step_t step = { &gw->stream, flush, Z_OK };
+        compression_stream_call(&gw->in_use, zlib_deflate_step, &step, gw->stream.avail_in);
+        ret = step.ret;
+        if (ret == Z_STREAM_ERROR) {
+            rb_raise(rb_eRuntimeError, "Compression failed: %s",
+                     gw->stream.msg ? gw->stream.msg : "stream error");
+        }
+
+        size_t have = STREAM_CHUNK_SIZE - gw->stream.avail_out;
+        if (have > 0) {
+            /* The IO may keep the String, so deflate continues in a new one */
+            VALUE chunk = gw->out;
+            rb_str_set_len(chunk, (long)have);
+            gw->out = rb_str_buf_new(STREAM_CHUNK_SIZE);
+            rb_funcall(gw->io, id_write, 1, chunk);
+        }
+    } while (gw->stream.avail_out == 0);
+}
 
-    VALUE result = rb_str_new((const char *)output, compressed_len);
-    free(output);
+/*
+ * Create a streaming gzip compressor
+ *
+ * @param dest [String, IO] file path (created/truncated), or any object responding to write
+ * @param level [Integer] compression level (keyword, 0-9, default 6)
+ */
+static VALUE gzip_writer_initialize(int argc, VALUE *argv, VALUE self) {
+    VALUE dest, opts;
+    rb_scan_args(argc, argv, "1:", &dest, &opts);
+    VALUE level = Qnil;
+    if (!NIL_P(opts)) {
+        VALUE val;
+        rb_get_kwargs(opts, &id_level, 0, 1, &val);
+        if (val != Qundef) level = val;
+    }
+    int compression_level = compression_level_arg(level);
 
-    return result;
+    gzip_writer_t *gw;
+    TypedData_Get_Struct(self, gzip_writer_t, &gzip_writer_type, gw);
+    if (gw->initialized) {
+        rb_raise(rb_eRuntimeError, "GzipWriter already initialized");
+    }
+
+    /* Open the IO first: a bad path must leave the writer uninitialized */
+    int owns_io;
+    VALUE io = stream_open_io(dest, "wb", &owns_io);
+
+    /* windowBits 15 + 16 = gzip format */
+    int ret = deflateInit2(&gw->stream, compression_level, Z_DEFLATED,
+                           15 + 16, 8, Z_DEFAULT_STRATEGY);
+    if (ret != Z_OK) {
+        if (owns_io) rb_io_close(io);
+        rb_raise(rb_eRuntimeError, "Failed to initialize compression: %s",
+                 gw->stream.msg ? gw->stream.msg : "unknown error");
+    }
+    gw->io = io;
+    gw->owns_io = owns_io;
+    gw->out = rb_str_buf_new(STREAM_CHUNK_SIZE);
+    gw->initialized = 1;
+    return self;
 }
 
 /*
- * Decompress deflate data (raw zlib format, no header)
+ * Compress data into the stream
  *
- * @param data [String] Deflate-compressed data
- * @return [String] Decompressed data
- * @raise [RuntimeError] if decompression fails
+ * @param data [String] uncompressed bytes
+ * @return [Integer] number of bytes consumed
  */
-VALUE konpeito_compression_inflate(VALUE self, VALUE data) {
-    Check_Type(data, T_STRING);
+static VALUE gzip_writer_write(VALUE self, VALUE data) {
+    gzip_writer_t *gw = gzip_writer_get(self);
+    StringValue(data);
+
+    /* Frozen snapshot: the IO runs Ruby code between deflate calls */
+    VALUE input = rb_str_new_frozen(data);
+    const char *ptr = RSTRING_PTR(input);
+    size_t len = RSTRING_LEN(input);
+    while (len > 0) {
+        uInt slice = len > STREAM_MAX_SLICE ? STREAM_MAX_SLICE : (uInt)len;
+        gw->stream.next_in = (Bytef *)ptr;
+        gw->stream.avail_in = slice;
+        gzip_writer_run(gw, Z_NO_FLUSH);
+        ptr += slice;
+        len -= slice;
+    }
+    gw->stream.next_in = NULL;
+    RB_GC_GUARD(input);
+    return LONG2NUM(RSTRING_LEN(data));
+}
 
-    const unsigned char *input = (const unsigned char *)RSTRING_PTR(data);
-    size_t input_len = RSTRING_LEN(data);
+static VALUE gzip_writer_append(VALUE self, VALUE data) {
+    gzip_writer_write(self, data);
+    return self;
+}
 
-    /* Start with a reasonable output buffer size */
-    size_t output_size = input_len * 4;
-    if (output_size < CHUNK_SIZE) output_size = CHUNK_SIZE;
-    unsigned char *output = malloc(output_size);
-    if (!output) {
-        rb_raise(rb_eNoMemError, "Failed to allocate decompression buffer");
-        return Qnil;
+/* Emit everything compressed so far (Z_SYNC_FLUSH), e.g. before a network pause */
+static VALUE gzip_writer_flush(VALUE self) {
+    gzip_writer_t *gw = gzip_writer_get(self);
+    gzip_writer_run(gw, Z_SYNC_FLUSH);
+    return self;
+}
+
+/* Write the gzip trailer; the IO stays open */
+static VALUE gzip_writer_finish(VALUE self) {
+    gzip_writer_t *gw = gzip_writer_get(self);
+    gzip_writer_run(gw, Z_FINISH);
+    gw->finished = 1;
+    return gw->io;
+}
+
+/* Finish the stream, and close the IO if it was opened from a path */
+static VALUE gzip_writer_close(VALUE self) {
+    gzip_writer_t *gw;
+    TypedData_Get_Struct(self, gzip_writer_t, &gzip_writer_type, gw);
+    if (gw->closed || !gw->initialized) return Qnil;
+
+    if (!gw->finished) {
+        gzip_writer_finish(self);
+    }
+    gw->closed = 1;
+    if (gw->owns_io) {
+        rb_io_close(gw->io);
     }
+    return Qnil;
+}
 
-    /* Initialize zlib stream for raw inflate */
+typedef struct {
     z_stream stream;
-    memset(&stream, 0, sizeof(stream));
+    VALUE io;
+    VALUE in;           /* compressed chunk that next_in points into */
+    VALUE pending;      /* decompressed bytes peeked by eof? */
+    int owns_io;
+    int initialized;    /* inflateInit2 succeeded */
+    int eof;            /* every member decompressed and the input exhausted */
+    int closed;
+    int in_use;         /* a thread is inside inflate without the GVL */
+} gzip_reader_t;
+
+static void gzip_reader_mark(void *ptr) {
+    gzip_reader_t *gr = (gzip_reader_t *)ptr;
+    rb_gc_mark(gr->io);
+    rb_gc_mark(gr->in);  /* pinned: next_in points into it */
+    rb_gc_mark(gr->pending);
+}
 
-    /* windowBits -15 = raw inflate (no zlib header) */
-    int ret = inflateInit2(&stream, -15);
+static void gzip_reader_free(void *ptr) {
+    gzip_reader_t *gr = (gzip_reader_t *)ptr;
+    if (gr->initialized) {
+        inflateEnd(&gr->stream);
+    }
+    ruby_xfree(gr);
+}
+
+static const rb_data_type_t gzip_reader_type = {
+    "KonpeitoCompression::GzipReader",
+    { gzip_reader_mark, gzip_reader_free, NULL, },
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE gzip_reader_alloc(VALUE klass) {
+    gzip_reader_t *gr;
+    VALUE obj = TypedData_Make_Struct(klass, gzip_reader_t, &gzip_reader_type, gr);
+    gr->io = Qnil;
+    gr->in = Qnil;
+    gr->pending = Qnil;
+    return obj;
+}
+
+static gzip_reader_t *gzip_reader_get(VALUE self) {
+    gzip_reader_t *gr;
+    TypedData_Get_Struct(self, gzip_reader_t, &gzip_reader_type, gr);
+    if (!gr->initialized) {
+        rb_raise(rb_eRuntimeError, "uninitialized GzipReader");
+    }
+    if (gr->closed) {
+        rb_raise(rb_eIOError, "closed GzipReader");
+    }
+    if (gr->in_use) {
+        rb_raise(rb_eRuntimeError, "GzipReader is in use by another thread");
+    }
+    return gr;
+}
+
+/* Load the next compressed chunk; 0 when the IO is exhausted */
+static int gzip_reader_fill(gzip_reader_t *gr) {
+    VALUE chunk = rb_funcall(gr->io, id_read, 1, INT2FIX(STREAM_CHUNK_SIZE));
+    if (NIL_P(chunk)) {
+        return 0;
+    }
+    StringValue(chunk);
+    if (RSTRING_LEN(chunk) == 0) {
+        return 0;
+    }
+    /* Frozen so the source cannot change it while inflate reads it */
+    chunk = rb_str_new_frozen(chunk);
+    gr->in = chunk;
+    gr->stream.next_in = (Bytef *)RSTRING_PTR(chunk);
+    gr->stream.avail_in = (uInt)RSTRING_LEN(chunk);
+    return 1;
+}
+
+/*
+ * Decompress into buf until it holds want bytes or the stream ends.
+ * Concatenated gzip members are read as one stream, like gunzip(1).
+ */
+static void gzip_reader_run(gzip_reader_t *gr, VALUE buf, long want) {
+    while (!gr->eof && RSTRING_LEN(buf) < want) {
+        if (gr->stream.avail_in == 0 && !gzip_reader_fill(gr)) {
+            rb_raise(rb_eRuntimeError, "Decompression failed: unexpected end of gzip data");
+        }
+
+        long len = RSTRING_LEN(buf);
+        long room = want - len;
+        if (room > STREAM_CHUNK_SIZE) room = STREAM_CHUNK_SIZE;
+        rb_str_modify_expand(buf, room);
+        gr->stream.next_out = (Bytef *)RSTRING_PTR(buf) + len;
+        gr->stream.avail_out = (uInt)room;
+
+        zlib_step_t step = { &gr->stream, Z_NO_FLUSH, Z_OK };
+        compression_stream_call(&gr->in_use, zlib_inflate_step, &step, (size_t)room);
+        int ret = step.ret;
+        rb_str_set_len(buf, len + (room - (long)gr->stream.avail_out));
+
+        if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR) {
+            rb_raise(rb_eRuntimeError, "Decompression failed: %s",
+                     gr->stream.msg ? gr->stream.msg : "data error");
+        }
+        if (ret == Z_STREAM_END) {
+            /* Another member may follow */
+            if (gr->stream.avail_in == 0 && !gzip_reader_fill(gr)) {
+                gr->eof = 1;
+            } else {
+                inflateReset(&gr->stream);
+            }
+        }
+    }
+}
+
+/* Output buffer for the next read, starting with any bytes peeked by eof? */
+static VALUE gzip_reader_buffer(gzip_reader_t *gr, long capa) {
+    if (!NIL_P(gr->pending)) {
+        VALUE buf = gr->pending;
+        gr->pending = Qnil;
+        return buf;
+    }
+    return rb_str_buf_new(capa);
+}
+
+/*
+ * Create a streaming gzip decompressor
+ *
+ * @param source [String, IO] file path, or any object responding to read(n)
+ */
+static VALUE gzip_reader_initialize(VALUE self, VALUE source) {
+    gzip_reader_t *gr;
+    TypedData_Get_Struct(self, gzip_reader_t, &gzip_reader_type, gr);
+    if (gr->initialized) {
+        rb_raise(rb_eRuntimeError, "GzipReader already initialized");
+    }
+
+    /* Open the IO first: a bad path must leave the reader uninitialized */
+    int owns_io;
+    VALUE io = stream_open_io(source, "rb", &owns_io);
+
+    /* windowBits 15 + 32 = auto-detect gzip/zlib */
+    int ret = inflateInit2(&gr->stream, 15 + 32);
     if (ret != Z_OK) {
-        free(output);
+        if (owns_io) rb_io_close(io);
         rb_raise(rb_eRuntimeError, "Failed to initialize decompression: %s",
-                 stream.msg ? stream.msg : "unknown error");
-        return Qnil;
+                 gr->stream.msg ? gr->stream.msg : "unknown error");
     }
+    gr->io = io;
+    gr->owns_io = owns_io;
+    gr->initialized = 1;
+    return self;
+}
 
-    stream.next_in = (Bytef *)input;
-    stream.avail_in = (uInt)input_len;
+/*
+ * Read decompressed data
+ *
+ * @param length [Integer, nil] maximum bytes to return; nil reads to the end
+ * @return [String, nil] decompressed bytes; nil at end of stream when length is given
+ * @raise [RuntimeError] if the data is corrupt or truncated
+ */
+static VALUE gzip_reader_read(int argc, VALUE *argv, VALUE self) {
+    VALUE length;
+    rb_scan_args(argc, argv, "01", &length);
+    gzip_reader_t *gr = gzip_reader_get(self);
+
+    if (NIL_P(length)) {
+        VALUE buf = gzip_reader_buffer(gr, STREAM_CHUNK_SIZE);
+        while (!gr->eof) {
+            gzip_reader_run(gr, buf, RSTRING_LEN(buf) + STREAM_CHUNK_SIZE);
+        }
+        return buf;
+    }
 
-    size_t total_out = 0;
+    long want = NUM2LONG(length);
+    if (want < 0) {
+        rb_raise(rb_eArgError, "negative length %ld given", want);
+    }
+    if (want == 0) {
+        return rb_str_new(0, 0);
+    }
+    VALUE buf = gzip_reader_buffer(gr, want < STREAM_CHUNK_SIZE ? want : STREAM_CHUNK_SIZE);
+    gzip_reader_run(gr, buf, want);
+    return RSTRING_LEN(buf) == 0 ? Qnil : buf;
+}
 
-    do {
-        /* Expand buffer if needed */
-        if (total_out >= output_size) {
-            output_size *= 2;
-            unsigned char *new_output = realloc(output, output_size);
-            if (!new_output) {
-                inflateEnd(&stream);
-                free(output);
-                rb_raise(rb_eNoMemError, "Failed to expand decompression buffer");
-                return Qnil;
-            }
-            output = new_output;
+/*
+ * Yield the decompressed data in chunks of up to 64KB
+ *
+ * @yield [chunk] decompressed bytes
+ * @return [nil]
+ */
+static VALUE gzip_reader_each_chunk(VALUE self) {
+    RETURN_ENUMERATOR(self, 0, 0);
+    gzip_reader_t *gr = gzip_reader_get(self);
+    while (!gr->eof || !NIL_P(gr->pending)) {
+        VALUE buf = gzip_reader_buffer(gr, STREAM_CHUNK_SIZE);
+        gzip_reader_run(gr, buf, STREAM_CHUNK_SIZE);
+        if (RSTRING_LEN(buf) > 0) {
+            rb_yield(buf);
+        }
+    }
+    return Qnil;
+}
+
+static VALUE gzip_reader_eof_p(VALUE self) {
+    gzip_reader_t *gr = gzip_reader_get(self);
+    if (!NIL_P(gr->pending)) return Qfalse;
+    if (!gr->eof) {
+        /* Peek one byte so eof? is exact; read returns it first */
+        VALUE buf = rb_str_buf_new(1);
+        gzip_reader_run(gr, buf, 1);
+        if (RSTRING_LEN(buf) > 0) {
+            gr->pending = buf;
+            return Qfalse;
         }
+    }
+    return Qtrue;
+}
 
-        stream.next_out = output + total_out;
-        stream.avail_out = (uInt)(output_size - total_out);
+/* Close the IO if it was opened from a path */
+static VALUE gzip_reader_close(VALUE self) {
+    gzip_reader_t *gr;
+    TypedData_Get_Struct(self, gzip_reader_t, &gzip_reader_type, gr);
+    if (gr->closed || !gr->initialized) return Qnil;
 
-        ret = inflate(&stream, Z_NO_FLUSH);
+    gr->closed = 1;
+    if (gr->owns_io) {
+        rb_io_close(gr->io);
+    }
+    return Qnil;
+}
 
-        if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR) {
-            inflateEnd(&stream);
-            free(output);
-            rb_raise(rb_eRuntimeError, "Decompression failed: %s",
-                     stream.msg ? stream.msg : "data error");
-            return Qnil;
+/*
+ * Parallel gzip (pigz-style)
+ *
+ * The input is cut into fixed-size blocks that are deflated independently
+ * on native threads. Each block is primed with the last 32KB of the block
+ * before it, so the ratio stays close to a single stream; every block but
+ * the last ends with a sync flush so the raw deflate outputs concatenate
+ * into one valid stream. The per-block CRCs are joined with crc32_combine.
+ */
+
+#define GZIP_PARALLEL_BLOCK_SIZE (128 * 1024)
+#define GZIP_PARALLEL_DICT_SIZE (32 * 1024)
+#define GZIP_PARALLEL_MAX_THREADS 64
+
+typedef struct {
+    const Bytef *in;
+    size_t len;
+    const Bytef *dict;  /* tail of the previous block, NULL for the first */
+    size_t dict_len;
+    int last;
+    unsigned char *out; /* malloc'd raw deflate output */
+    size_t out_len;
+    uLong crc;
+    int err;            /* zlib status, Z_OK on success */
+} gzip_block_job_t;
+
+typedef struct {
+    gzip_block_job_t *jobs;
+    long count;
+    long next;
+    size_t len;     /* input bytes over all blocks */
+    int nthreads;
+    int level;
+} gzip_block_pool_t;
+
+/* Runs without the GVL: only zlib and malloc */
+static void gzip_block_job_run(gzip_block_job_t *job, int level) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    job->crc = crc32(0L, job->in, (uInt)job->len);
+
+    int ret = deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    if (ret != Z_OK) {
+        job->err = ret;
+        return;
+    }
+    if (job->dict) {
+        ret = deflateSetDictionary(&stream, job->dict, (uInt)job->dict_len);
+        if (ret != Z_OK) {
+            deflateEnd(&stream);
+            job->err = ret;
+            return;
         }
+    }
 
-        total_out = stream.total_out;
+    /* Room for the sync flush marker on top of the bound */
+    size_t capa = deflateBound(&stream, (uLong)job->len) + 16;
+    job->out = malloc(capa);
+    if (!job->out) {
+        deflateEnd(&stream);
+        job->err = Z_MEM_ERROR;
+        return;
+    }
 
-    } while (ret != Z_STREAM_END);
+    stream.next_in = (Bytef *)job->in;
+    stream.avail_in = (uInt)job->len;
+    stream.next_out = job->out;
+    stream.avail_out = (uInt)capa;
+    ret = deflate(&stream, job->last ? Z_FINISH : Z_SYNC_FLUSH);
+    if (job->last ? ret != Z_STREAM_END : (ret != Z_OK || stream.avail_out == 0)) {
+        job->err = ret == Z_OK ? Z_BUF_ERROR : ret;
+    } else {
+        job->out_len = capa - stream.avail_out;
+    }
+    deflateEnd(&stream);
+}
 
-    inflateEnd(&stream);
+static void *gzip_block_pool_worker(void *arg) {
+    gzip_block_pool_t *pool = (gzip_block_pool_t *)arg;
+    long i;
+    while ((i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED)) < pool->count) {
+        gzip_block_job_run(&pool->jobs[i], pool->level);
+    }
+    return NULL;
+}
 
-    VALUE result = rb_str_new((const char *)output, total_out);
-    free(output);
+/* Called without the GVL: the calling thread works alongside nthreads - 1 helpers */
+static void *gzip_block_pool_run(void *arg) {
+    gzip_block_pool_t *pool = (gzip_block_pool_t *)arg;
+#ifndef _WIN32
+    pthread_t tids[GZIP_PARALLEL_MAX_THREADS];
+    int started = 0;
+    for (int t = 1; t < pool->nthreads; t++) {
+        if (pthread_create(&tids[started], NULL, gzip_block_pool_worker, pool) != 0) break;
+        started++;
+    }
+    gzip_block_pool_worker(pool);
+    for (int t = 0; t < started; t++) pthread_join(tids[t], NULL);
+#else
+    gzip_block_pool_worker(pool);
+#endif
+    return NULL;
+}
+
+static int compression_default_thread_count(void) {
+#ifndef _WIN32
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 0) return n > GZIP_PARALLEL_MAX_THREADS ? GZIP_PARALLEL_MAX_THREADS : (int)n;
+#endif
+    return 1;
+}
 
+static void gzip_put_le32(unsigned char *p, uLong v) {
+    p[0] = (unsigned char)(v & 0xff);
+    p[1] = (unsigned char)((v >> 8) & 0xff);
+    p[2] = (unsigned char)((v >> 16) & 0xff);
+    p[3] = (unsigned char)((v >> 24) & 0xff);
+}
+
+/*
+ * Compress the blocks, then stitch header + block outputs + trailer into
+ * one gzip member. Runs under rb_ensure so the jobs and block outputs are
+ * freed even when the interrupt check after the no-GVL run raises.
+ */
+static VALUE gzip_parallel_body(VALUE arg) {
+    gzip_block_pool_t *pool = (gzip_block_pool_t *)arg;
+    if (pool->count == 1) {
+        compression_call(gzip_block_pool_run, pool, pool->len);
+    } else {
+        rb_thread_call_without_gvl(gzip_block_pool_run, pool, NULL, NULL);
+    }
+
+    size_t total = 10 + 8;
+    uLong crc = crc32(0L, Z_NULL, 0);
+    uLong isize = 0;
+    for (long i = 0; i < pool->count; i++) {
+        gzip_block_job_t *job = &pool->jobs[i];
+        if (job->err == Z_MEM_ERROR) {
+            rb_raise(rb_eNoMemError, "Failed to allocate compression buffer");
+        }
+        if (job->err != Z_OK) {
+            rb_raise(rb_eRuntimeError, "Compression failed: %s", zError(job->err));
+        }
+        total += job->out_len;
+        crc = crc32_combine(crc, job->crc, (z_off_t)job->len);
+        isize += (uLong)job->len;
+    }
+
+    VALUE result = rb_str_buf_new((long)total);
+    unsigned char *p = (unsigned char *)RSTRING_PTR(result);
+
+    /* Header: magic, deflate, no flags, no mtime, XFL, OS (as zlib writes it) */
+    p[0] = 0x1f;
+    p[1] = 0x8b;
+    p[2] = Z_DEFLATED;
+    p[3] = 0;
+    gzip_put_le32(p + 4, 0);
+    p[8] = pool->level == Z_BEST_COMPRESSION ? 2 : (pool->level == Z_BEST_SPEED ? 4 : 0);
+    p[9] = 3;
+    p += 10;
+
+    for (long i = 0; i < pool->count; i++) {
+        memcpy(p, pool->jobs[i].out, pool->jobs[i].out_len);
+        p += pool->jobs[i].out_len;
+    }
+
+    gzip_put_le32(p, crc & 0xffffffffUL);
+    gzip_put_le32(p + 4, isize & 0xffffffffUL);
+    rb_str_set_len(result, (long)total);
     return result;
 }
 
+static VALUE gzip_parallel_ensure(VALUE arg) {
+    gzip_block_pool_t *pool = (gzip_block_pool_t *)arg;
+    for (long i = 0; i < pool->count; i++) {
+        free(pool->jobs[i].out);
+    }
+    ruby_xfree(pool->jobs);
+    return Qnil;
+}
+
 /*
- * Compress data using zlib format (with header)
+ * Compress data to gzip format using all cores
+ *
+ * The output is a single standard gzip member (readable by gunzip and
+ * Zlib.gunzip), slightly larger than gzip's because of the block
+ * boundaries. Inputs of one block (128KB) or less are compressed on the
+ * calling thread (still without the GVL above 32KB).
  *
  * @param data [String] Data to compress
- * @return [String] Zlib-compressed data
+ * @param level [Integer] compression level (keyword, 0-9, default 6)
+ * @param threads [Integer] worker threads (keyword, default: number of CPUs)
+ * @return [String] Gzip-compressed data (binary string)
  * @raise [RuntimeError] if compression fails
  */
-VALUE konpeito_compression_zlib_compress(VALUE self, VALUE data) {
+VALUE konpeito_compression_gzip_parallel(int argc, VALUE *argv, VALUE self) {
+    VALUE data, opts;
+    rb_scan_args(argc, argv, "1:", &data, &opts);
     Check_Type(data, T_STRING);
 
-    const unsigned char *input = (const unsigned char *)RSTRING_PTR(data);
-    size_t input_len = RSTRING_LEN(data);
-
-    uLongf output_len = compressBound(input_len);
-    unsigned char *output = malloc(output_len);
-    if (!output) {
-        rb_raise(rb_eNoMemError, "Failed to allocate compression buffer");
-        return Qnil;
+    gzip_block_pool_t pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.level = Z_DEFAULT_COMPRESSION;
+    pool.nthreads = compression_default_thread_count();
+    if (!NIL_P(opts)) {
+        ID kw[2] = { id_level, id_threads };
+        VALUE vals[2];
+        rb_get_kwargs(opts, kw, 0, 2, vals);
+        if (vals[0] != Qundef) pool.level = compression_level_arg(vals[0]);
+        if (vals[1] != Qundef) {
+            int n = NUM2INT(vals[1]);
+            if (n < 1) rb_raise(rb_eArgError, "threads must be positive");
+            pool.nthreads = n > GZIP_PARALLEL_MAX_THREADS ? GZIP_PARALLEL_MAX_THREADS : n;
+        }
     }
 
-    int ret = compress(output, &output_len, input, input_len);
-    if (ret != Z_OK) {
-        free(output);
-        rb_raise(rb_eRuntimeError, "Compression failed with code %d", ret);
-        return Qnil;
+    /* Frozen snapshot: workers read it without the GVL */
+    VALUE input = rb_str_new_frozen(data);
+    const Bytef *ptr = (const Bytef *)RSTRING_PTR(input);
+    size_t len = RSTRING_LEN(input);
+
+    long count = len == 0 ? 1 : (long)((len + GZIP_PARALLEL_BLOCK_SIZE - 1) / GZIP_PARALLEL_BLOCK_SIZE);
+    pool.jobs = ruby_xcalloc(count, sizeof(gzip_block_job_t));
+    pool.count = count;
+    for (long i = 0; i < count; i++) {
+        gzip_block_job_t *job = &pool.jobs[i];
+        size_t offset = (size_t)i * GZIP_PARALLEL_BLOCK_SIZE;
+        job->in = ptr + offset;
+        job->len = len - offset < GZIP_PARALLEL_BLOCK_SIZE ? len - offset : GZIP_PARALLEL_BLOCK_SIZE;
+        job->last = i == count - 1;
+        if (i > 0) {
+            job->dict = job->in - GZIP_PARALLEL_DICT_SIZE;
+            job->dict_len = GZIP_PARALLEL_DICT_SIZE;
+        }
     }
 
-    VALUE result = rb_str_new((const char *)output, output_len);
-    free(output);
+    pool.len = len;
+    if (pool.nthreads > count) pool.nthreads = (int)count;
 
+    VALUE result = rb_ensure(gzip_parallel_body, (VALUE)&pool, gzip_parallel_ensure, (VALUE)&pool);
+    RB_GC_GUARD(input);
     return result;
 }
 
+#if defined(HAVE_ZSTD_H) || defined(HAVE_LZ4FRAME_H)
 /*
- * Decompress zlib data (with header)
+ * zstd and lz4 codecs
  *
- * @param data [String] Zlib-compressed data
- * @param max_size [Integer] Maximum decompressed size (for safety)
- * @return [String] Decompressed data
- * @raise [RuntimeError] if decompression fails
+ * Both libraries are optional (see extconf.rb); the module functions are
+ * only defined when the library was found at build time. Compression and
+ * decompression contexts are created once per thread and reset between
+ * calls instead of being set up and torn down on every call.
  */
-VALUE konpeito_compression_zlib_decompress(VALUE self, VALUE data, VALUE max_size) {
+
+/* Same cap as zlib_decompress when max_size: is not given */
+#define CODEC_DEFAULT_MAX_OUTPUT (100 * 1024 * 1024)
+
+typedef struct {
+#ifdef HAVE_ZSTD_H
+    ZSTD_CCtx *zstd_cctx;
+    ZSTD_DCtx *zstd_dctx;
+#endif
+#ifdef HAVE_LZ4FRAME_H
+    LZ4F_cctx *lz4_cctx;
+    LZ4F_dctx *lz4_dctx;
+#endif
+} codec_contexts_t;
+
+static void codec_contexts_free(void *ptr) {
+    codec_contexts_t *ctx = (codec_contexts_t *)ptr;
+    if (!ctx) return;
+#ifdef HAVE_ZSTD_H
+    ZSTD_freeCCtx(ctx->zstd_cctx);
+    ZSTD_freeDCtx(ctx->zstd_dctx);
+#endif
+#ifdef HAVE_LZ4FRAME_H
+    if (ctx->lz4_cctx) LZ4F_freeCompressionContext(ctx->lz4_cctx);
+    if (ctx->lz4_dctx) LZ4F_freeDecompressionContext(ctx->lz4_dctx);
+#endif
+    free(ctx);
+}
+
+#ifndef _WIN32
+/* Freed by the key destructor when the owning thread exits */
+static pthread_key_t codec_contexts_key;
+#else
+static __declspec(thread) codec_contexts_t *codec_contexts_tls;
+#endif
+
+/* The calling thread's contexts; members are created on first use */
+static codec_contexts_t *codec_contexts(void) {
+#ifndef _WIN32
+    codec_contexts_t *ctx = pthread_getspecific(codec_contexts_key);
+#else
+    codec_contexts_t *ctx = codec_contexts_tls;
+#endif
+    if (ctx) return ctx;
+
+    ctx = calloc(1, sizeof(codec_contexts_t));
+    if (!ctx) rb_memerror();
+#ifndef _WIN32
+    if (pthread_setspecific(codec_contexts_key, ctx) != 0) {
+        free(ctx);
+        rb_memerror();
+    }
+#else
+    codec_contexts_tls = ctx;
+#endif
+    return ctx;
+}
+
+static size_t codec_max_output(VALUE max_size) {
+    if (NIL_P(max_size)) return CODEC_DEFAULT_MAX_OUTPUT;
+    long max = NUM2LONG(max_size);
+    if (max < 0) rb_raise(rb_eArgError, "max_size must not be negative");
+    return (size_t)max;
+}
+
+/* Grow a decompression buffer to the next size, bounded by max_output */
+static void codec_output_grow(VALUE buf, size_t *capa, size_t max_output) {
+    if (*capa >= max_output) {
+        rb_raise(rb_eRuntimeError, "Decompressed data exceeds maximum size");
+    }
+    size_t next = *capa * 2;
+    if (next > max_output) next = max_output;
+    rb_str_modify_expand(buf, (long)(next - RSTRING_LEN(buf)));
+    *capa = next;
+}
+
+static size_t codec_initial_output(size_t input_len, unsigned long long content_size, size_t max_output) {
+    size_t capa = input_len * 4;
+    if (content_size != 0 && content_size <= max_output) capa = (size_t)content_size;
+    if (capa < CHUNK_SIZE) capa = CHUNK_SIZE;
+    if (capa > max_output) capa = max_output;
+    return capa;
+}
+#endif
+
+#ifdef HAVE_ZSTD_H
+#define ZSTD_DEFAULT_LEVEL 3
+#define ZSTD_DEFAULT_DICT_SIZE (110 * 1024)
+
+static ID id_dict;
+static ID id_max_size;
+static ID id_size;
+static VALUE cZstdDictionary;
+
+/*
+ * Digested zstd dictionary: the CDict/DDict are built once and shared by
+ * every call that passes it as dict:.
+ */
+typedef struct {
+    ZSTD_CDict *cdict;
+    ZSTD_DDict *ddict;
+} zstd_dictionary_t;
+
+static void zstd_dictionary_free(void *ptr) {
+    zstd_dictionary_t *zd = (zstd_dictionary_t *)ptr;
+    ZSTD_freeCDict(zd->cdict);
+    ZSTD_freeDDict(zd->ddict);
+    ruby_xfree(zd);
+}
+
+static size_t zstd_dictionary_memsize(const void *ptr) {
+    const zstd_dictionary_t *zd = (const zstd_dictionary_t *)ptr;
+    return sizeof(*zd) + ZSTD_sizeof_CDict(zd->cdict) + ZSTD_sizeof_DDict(zd->ddict);
+}
+
+static const rb_data_type_t zstd_dictionary_type = {
+    "KonpeitoCompression::ZstdDictionary",
+    { NULL, zstd_dictionary_free, zstd_dictionary_memsize, },
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE zstd_dictionary_alloc(VALUE klass) {
+    zstd_dictionary_t *zd;
+    return TypedData_Make_Struct(klass, zstd_dictionary_t, &zstd_dictionary_type, zd);
+}
+
+static int zstd_level_arg(VALUE level) {
+    if (NIL_P(level)) return ZSTD_DEFAULT_LEVEL;
+    int lvl = NUM2INT(level);
+    if (lvl < ZSTD_minCLevel() || lvl > ZSTD_maxCLevel()) {
+        rb_raise(rb_eArgError, "Compression level must be %d-%d", ZSTD_minCLevel(), ZSTD_maxCLevel());
+    }
+    return lvl;
+}
+
+/*
+ * Load a zstd dictionary
+ *
+ * @param data [String] dictionary bytes (e.g. from zstd_train_dictionary)
+ * @param level [Integer] compression level baked into the dictionary (keyword, default 3)
+ */
+static VALUE zstd_dictionary_initialize(int argc, VALUE *argv, VALUE self) {
+    VALUE data, opts;
+    rb_scan_args(argc, argv, "1:", &data, &opts);
     Check_Type(data, T_STRING);
+    VALUE level = Qnil;
+    if (!NIL_P(opts)) {
+        VALUE val;
+        rb_get_kwargs(opts, &id_level, 0, 1, &val);
+        if (val != Qundef) level = val;
+    }
+    int lvl = zstd_level_arg(level);
 
-    const unsigned char *input = (const unsigned char *)RSTRING_PTR(data);
-    size_t input_len = RSTRING_LEN(data);
-    size_t max_output = NIL_P(max_size) ? 100 * 1024 * 1024 : (size_t)NUM2LONG(max_size); /* 100MB default */
+    zstd_dictionary_t *zd;
+    TypedData_Get_Struct(self, zstd_dictionary_t, &zstd_dictionary_type, zd);
+    if (zd->cdict) {
+        rb_raise(rb_eRuntimeError, "ZstdDictionary already initialized");
+    }
+    zd->cdict = ZSTD_createCDict(RSTRING_PTR(data), RSTRING_LEN(data), lvl);
+    zd->ddict = ZSTD_createDDict(RSTRING_PTR(data), RSTRING_LEN(data));
+    if (!zd->cdict || !zd->ddict) {
+        rb_raise(rb_eRuntimeError, "Failed to load zstd dictionary");
+    }
+    return self;
+}
 
-    /* Start with estimated output size */
-    size_t output_size = input_len * 4;
-    if (output_size < CHUNK_SIZE) output_size = CHUNK_SIZE;
-    if (output_size > max_output) output_size = max_output;
+/* Dictionary ID stored in the frames it compresses (0 for raw content) */
+static VALUE zstd_dictionary_id(VALUE self) {
+    zstd_dictionary_t *zd;
+    TypedData_Get_Struct(self, zstd_dictionary_t, &zstd_dictionary_type, zd);
+    if (!zd->ddict) {
+        rb_raise(rb_eRuntimeError, "uninitialized ZstdDictionary");
+    }
+    return UINT2NUM(ZSTD_getDictID_fromDDict(zd->ddict));
+}
 
-    unsigned char *output = malloc(output_size);
-    if (!output) {
-        rb_raise(rb_eNoMemError, "Failed to allocate decompression buffer");
-        return Qnil;
+static zstd_dictionary_t *zstd_dictionary_arg(VALUE dict) {
+    if (NIL_P(dict) || RB_TYPE_P(dict, T_STRING)) return NULL;
+    zstd_dictionary_t *zd;
+    TypedData_Get_Struct(dict, zstd_dictionary_t, &zstd_dictionary_type, zd);
+    if (!zd->cdict) {
+        rb_raise(rb_eRuntimeError, "uninitialized ZstdDictionary");
     }
+    return zd;
+}
 
-    uLongf destLen = (uLongf)output_size;
-    int ret;
+static ZSTD_CCtx *zstd_cctx(void) {
+    codec_contexts_t *ctx = codec_contexts();
+    if (!ctx->zstd_cctx) {
+        ctx->zstd_cctx = ZSTD_createCCtx();
+        if (!ctx->zstd_cctx) rb_memerror();
+    }
+    return ctx->zstd_cctx;
+}
+
+static ZSTD_DCtx *zstd_dctx(void) {
+    codec_contexts_t *ctx = codec_contexts();
+    if (!ctx->zstd_dctx) {
+        ctx->zstd_dctx = ZSTD_createDCtx();
+        if (!ctx->zstd_dctx) rb_memerror();
+    }
+    return ctx->zstd_dctx;
+}
+
+static void zstd_check(size_t ret, const char *what) {
+    if (ZSTD_isError(ret)) {
+        rb_raise(rb_eRuntimeError, "%s failed: %s", what, ZSTD_getErrorName(ret));
+    }
+}
 
+typedef struct {
+    ZSTD_CCtx *cctx;
+    const char *src;
+    size_t src_len;
+    char *dst;
+    size_t dst_capa;
+    size_t ret;     /* compressed size or zstd error code */
+} zstd_compress_job_t;
+
+static void *zstd_compress_run(void *arg) {
+    zstd_compress_job_t *job = (zstd_compress_job_t *)arg;
+    job->ret = ZSTD_compress2(job->cctx, job->dst, job->dst_capa, job->src, job->src_len);
+    return NULL;
+}
+
+/* Decompress until the output is full, the input is done, or no progress is made */
+typedef struct {
+    ZSTD_DCtx *dctx;
+    ZSTD_inBuffer in;
+    ZSTD_outBuffer out;
+    size_t ret;     /* 0 once a frame is complete, or a zstd error code */
+} zstd_decompress_job_t;
+
+static void *zstd_decompress_run(void *arg) {
+    zstd_decompress_job_t *job = (zstd_decompress_job_t *)arg;
+    do {
+        size_t in_before = job->in.pos;
+        size_t out_before = job->out.pos;
+        job->ret = ZSTD_decompressStream(job->dctx, &job->out, &job->in);
+        if (ZSTD_isError(job->ret)) break;
+        if (job->in.pos == in_before && job->out.pos == out_before) break;
+    } while (job->out.pos < job->out.size && (job->in.pos < job->in.size || job->ret != 0));
+    return NULL;
+}
+
+/*
+ * Compress data to a zstd frame
+ *
+ * @param data [String] Data to compress
+ * @param level [Integer] compression level (keyword, default 3; negative is faster)
+ * @param dict [String, ZstdDictionary] dictionary (keyword); a ZstdDictionary
+ *   is digested once and carries its own level
+ * @return [String] zstd-compressed data (binary string)
+ * @raise [RuntimeError] if compression fails
+ */
+VALUE konpeito_compression_zstd_compress(int argc, VALUE *argv, VALUE self) {
+    VALUE data, opts;
+    rb_scan_args(argc, argv, "1:", &data, &opts);
+    Check_Type(data, T_STRING);
+    VALUE vals[2] = { Qundef, Qundef };
+    if (!NIL_P(opts)) {
+        ID kw[2] = { id_level, id_dict };
+        rb_get_kwargs(opts, kw, 0, 2, vals);
+    }
+    int level = zstd_level_arg(vals[0] == Qundef ? Qnil : vals[0]);
+    VALUE dict = vals[1] == Qundef ? Qnil : vals[1];
+    zstd_dictionary_t *zd = zstd_dictionary_arg(dict);
+
+    ZSTD_CCtx *cctx = zstd_cctx();
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+    if (zd) {
+        zstd_check(ZSTD_CCtx_refCDict(cctx, zd->cdict), "Compression");
+    } else {
+        zstd_check(ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level), "Compression");
+        if (!NIL_P(dict)) {
+            zstd_check(ZSTD_CCtx_loadDictionary(cctx, RSTRING_PTR(dict), RSTRING_LEN(dict)), "Compression");
+        }
+    }
+
+    VALUE input = compression_pin(data);
+    zstd_compress_job_t job;
+    job.cctx = cctx;
+    job.src = RSTRING_PTR(input);
+    job.src_len = RSTRING_LEN(input);
+    job.dst_capa = ZSTD_compressBound(job.src_len);
+    VALUE result = rb_str_buf_new((long)job.dst_capa);
+    job.dst = RSTRING_PTR(result);
+
+    compression_call(zstd_compress_run, &job, job.src_len);
+    zstd_check(job.ret, "Compression");
+    rb_str_set_len(result, (long)job.ret);
+    RB_GC_GUARD(input);
+    RB_GC_GUARD(dict);
+    return result;
+}
+
+/*
+ * Decompress zstd data (concatenated frames are decoded in sequence)
+ *
+ * @param data [String] zstd-compressed data
+ * @param max_size [Integer] maximum decompressed size (keyword, default 100MB)
+ * @param dict [String, ZstdDictionary] dictionary used for compression (keyword)
+ * @return [String] Decompressed data
+ * @raise [RuntimeError] if decompression fails or exceeds max_size
+ */
+VALUE konpeito_compression_zstd_decompress(int argc, VALUE *argv, VALUE self) {
+    VALUE data, opts;
+    rb_scan_args(argc, argv, "1:", &data, &opts);
+    Check_Type(data, T_STRING);
+    VALUE vals[2] = { Qundef, Qundef };
+    if (!NIL_P(opts)) {
+        ID kw[2] = { id_max_size, id_dict };
+        rb_get_kwargs(opts, kw, 0, 2, vals);
+    }
+    size_t max_output = codec_max_output(vals[0] == Qundef ? Qnil : vals[0]);
+    VALUE dict = vals[1] == Qundef ? Qnil : vals[1];
+    zstd_dictionary_t *zd = zstd_dictionary_arg(dict);
+
+    VALUE pinned = compression_pin(data);
+    const char *input = RSTRING_PTR(pinned);
+    size_t input_len = RSTRING_LEN(pinned);
+    unsigned long long content_size = ZSTD_getFrameContentSize(input, input_len);
+    if (content_size == ZSTD_CONTENTSIZE_ERROR) {
+        rb_raise(rb_eRuntimeError, "Decompression failed: not zstd data");
+    }
+    if (content_size == ZSTD_CONTENTSIZE_UNKNOWN) content_size = 0;
+
+    ZSTD_DCtx *dctx = zstd_dctx();
+    ZSTD_DCtx_reset(dctx, ZSTD_reset_session_and_parameters);
+    if (zd) {
+        zstd_check(ZSTD_DCtx_refDDict(dctx, zd->ddict), "Decompression");
+    } else if (!NIL_P(dict)) {
+        zstd_check(ZSTD_DCtx_loadDictionary(dctx, RSTRING_PTR(dict), RSTRING_LEN(dict)), "Decompression");
+    }
+
+    size_t capa = codec_initial_output(input_len, content_size, max_output);
+    VALUE result = rb_str_buf_new((long)capa);
+    zstd_decompress_job_t job;
+    job.dctx = dctx;
+    job.in.src = input;
+    job.in.size = input_len;
+    job.in.pos = 0;
     while (1) {
-        ret = uncompress(output, &destLen, input, input_len);
+        if ((size_t)RSTRING_LEN(result) == capa) {
+            codec_output_grow(result, &capa, max_output);
+        }
+        job.out.dst = RSTRING_PTR(result);
+        job.out.size = capa;
+        job.out.pos = RSTRING_LEN(result);
+        compression_call(zstd_decompress_run, &job, input_len);
+        zstd_check(job.ret, "Decompression");
+        rb_str_set_len(result, (long)job.out.pos);
+        if (job.in.pos == job.in.size && job.ret == 0) break;
+        if (job.out.pos < capa) {
+            rb_raise(rb_eRuntimeError, "Decompression failed: truncated zstd data");
+        }
+    }
+    RB_GC_GUARD(pinned);
+    RB_GC_GUARD(dict);
+    return result;
+}
 
-        if (ret == Z_OK) {
-            break;
-        } else if (ret == Z_BUF_ERROR) {
-            /* Need bigger buffer */
-            output_size *= 2;
-            if (output_size > max_output) {
-                free(output);
-                rb_raise(rb_eRuntimeError, "Decompressed data exceeds maximum size");
-                return Qnil;
-            }
-            unsigned char *new_output = realloc(output, output_size);
-            if (!new_output) {
-                free(output);
-                rb_raise(rb_eNoMemError, "Failed to expand decompression buffer");
-                return Qnil;
-            }
-            output = new_output;
-            destLen = (uLongf)output_size;
-        } else {
-            free(output);
-            rb_raise(rb_eRuntimeError, "Decompression failed with code %d", ret);
-            return Qnil;
+/*
+ * Train a zstd dictionary from sample records
+ *
+ * Dictionaries pay off for many small, similar records (cache values,
+ * messages) that compress poorly on their own. Training needs a few
+ * hundred samples or more.
+ *
+ * @param samples [Array<String>] representative records
+ * @param size [Integer] maximum dictionary size in bytes (keyword, default 110KB)
+ * @return [String] dictionary bytes, for ZstdDictionary.new or dict:
+ * @raise [RuntimeError] if training fails (e.g. too few samples)
+ */
+VALUE konpeito_compression_zstd_train_dictionary(int argc, VALUE *argv, VALUE self) {
+    VALUE samples, opts;
+    rb_scan_args(argc, argv, "1:", &samples, &opts);
+    Check_Type(samples, T_ARRAY);
+    size_t dict_capa = ZSTD_DEFAULT_DICT_SIZE;
+    if (!NIL_P(opts)) {
+        VALUE val;
+        rb_get_kwargs(opts, &id_size, 0, 1, &val);
+        if (val != Qundef) {
+            long n = NUM2LONG(val);
+            if (n <= 0) rb_raise(rb_eArgError, "size must be positive");
+            dict_capa = (size_t)n;
         }
     }
 
-    VALUE result = rb_str_new((const char *)output, destLen);
-    free(output);
+    long count = RARRAY_LEN(samples);
+    size_t total = 0;
+    for (long i = 0; i < count; i++) {
+        VALUE sample = RARRAY_AREF(samples, i);
+        Check_Type(sample, T_STRING);
+        total += RSTRING_LEN(sample);
+    }
+
+    /* ZDICT wants the samples back to back plus their sizes */
+    VALUE buffer = rb_str_buf_new((long)total);
+    VALUE sizes_buf = rb_str_buf_new((long)(sizeof(size_t) * (count > 0 ? count : 1)));
+    size_t *sizes = (size_t *)RSTRING_PTR(sizes_buf);
+    for (long i = 0; i < count; i++) {
+        VALUE sample = RARRAY_AREF(samples, i);
+        rb_str_buf_cat(buffer, RSTRING_PTR(sample), RSTRING_LEN(sample));
+        sizes[i] = RSTRING_LEN(sample);
+    }
+
+    VALUE dict = rb_str_buf_new((long)dict_capa);
+    size_t dict_len = ZDICT_trainFromBuffer(RSTRING_PTR(dict), dict_capa,
+                                            RSTRING_PTR(buffer), sizes, (unsigned)count);
+    if (ZDICT_isError(dict_len)) {
+        rb_raise(rb_eRuntimeError, "Dictionary training failed: %s", ZDICT_getErrorName(dict_len));
+    }
+    rb_str_set_len(dict, (long)dict_len);
+    RB_GC_GUARD(buffer);
+    RB_GC_GUARD(sizes_buf);
+    return dict;
+}
+#endif
+
+#ifdef HAVE_LZ4FRAME_H
+static LZ4F_cctx *lz4_cctx(void) {
+    codec_contexts_t *ctx = codec_contexts();
+    if (!ctx->lz4_cctx && LZ4F_isError(LZ4F_createCompressionContext(&ctx->lz4_cctx, LZ4F_VERSION))) {
+        ctx->lz4_cctx = NULL;
+        rb_memerror();
+    }
+    return ctx->lz4_cctx;
+}
+
+static LZ4F_dctx *lz4_dctx(void) {
+    codec_contexts_t *ctx = codec_contexts();
+    if (!ctx->lz4_dctx && LZ4F_isError(LZ4F_createDecompressionContext(&ctx->lz4_dctx, LZ4F_VERSION))) {
+        ctx->lz4_dctx = NULL;
+        rb_memerror();
+    }
+    return ctx->lz4_dctx;
+}
+
+static void lz4_check(size_t ret, const char *what) {
+    if (LZ4F_isError(ret)) {
+        rb_raise(rb_eRuntimeError, "%s failed: %s", what, LZ4F_getErrorName(ret));
+    }
+}
+
+typedef struct {
+    LZ4F_cctx *cctx;
+    const LZ4F_preferences_t *prefs;
+    const char *src;
+    size_t src_len;
+    char *dst;
+    size_t dst_capa;
+    size_t ret;     /* frame size or LZ4F error code */
+} lz4_compress_job_t;
+
+static void *lz4_compress_run(void *arg) {
+    lz4_compress_job_t *job = (lz4_compress_job_t *)arg;
+    size_t pos = LZ4F_compressBegin(job->cctx, job->dst, job->dst_capa, job->prefs);
+    if (LZ4F_isError(pos)) {
+        job->ret = pos;
+        return NULL;
+    }
+    size_t n = LZ4F_compressUpdate(job->cctx, job->dst + pos, job->dst_capa - pos, job->src, job->src_len, NULL);
+    if (LZ4F_isError(n)) {
+        job->ret = n;
+        return NULL;
+    }
+    pos += n;
+    n = LZ4F_compressEnd(job->cctx, job->dst + pos, job->dst_capa - pos, NULL);
+    job->ret = LZ4F_isError(n) ? n : pos + n;
+    return NULL;
+}
+
+/* Decompress until the output is full, the input is done, or no progress is made */
+typedef struct {
+    LZ4F_dctx *dctx;
+    const char *src;
+    size_t src_len;
+    size_t src_pos;
+    char *dst;
+    size_t dst_capa;
+    size_t dst_len;
+    size_t ret;     /* 0 once a frame is complete, or an LZ4F error code */
+} lz4_decompress_job_t;
+
+static void *lz4_decompress_run(void *arg) {
+    lz4_decompress_job_t *job = (lz4_decompress_job_t *)arg;
+    while (job->dst_len < job->dst_capa) {
+        size_t out_len = job->dst_capa - job->dst_len;
+        size_t in_len = job->src_len - job->src_pos;
+        job->ret = LZ4F_decompress(job->dctx, job->dst + job->dst_len, &out_len,
+                                   job->src + job->src_pos, &in_len, NULL);
+        if (LZ4F_isError(job->ret)) break;
+        job->src_pos += in_len;
+        job->dst_len += out_len;
+        if (job->src_pos == job->src_len && job->ret == 0) break;
+        if (in_len == 0 && out_len == 0) break;
+    }
+    return NULL;
+}
 
+/*
+ * Compress data to an LZ4 frame (readable by the lz4 command line tool)
+ *
+ * @param data [String] Data to compress
+ * @param level [Integer] compression level (keyword, default 0 = fast; 3-12 = high compression)
+ * @return [String] LZ4-compressed data (binary string)
+ * @raise [RuntimeError] if compression fails
+ */
+VALUE konpeito_compression_lz4_compress(int argc, VALUE *argv, VALUE self) {
+    VALUE data, opts;
+    rb_scan_args(argc, argv, "1:", &data, &opts);
+    Check_Type(data, T_STRING);
+    int level = 0;
+    if (!NIL_P(opts)) {
+        VALUE val;
+        rb_get_kwargs(opts, &id_level, 0, 1, &val);
+        if (val != Qundef && !NIL_P(val)) level = NUM2INT(val);
+    }
+
+    size_t input_len = RSTRING_LEN(data);
+    LZ4F_preferences_t prefs;
+    memset(&prefs, 0, sizeof(prefs));
+    prefs.compressionLevel = level;
+    prefs.frameInfo.contentSize = input_len;
+
+    VALUE input = compression_pin(data);
+    lz4_compress_job_t job;
+    job.cctx = lz4_cctx();
+    job.prefs = &prefs;
+    job.src = RSTRING_PTR(input);
+    job.src_len = input_len;
+    job.dst_capa = LZ4F_compressFrameBound(input_len, &prefs);
+    VALUE result = rb_str_buf_new((long)job.dst_capa);
+    job.dst = RSTRING_PTR(result);
+
+    compression_call(lz4_compress_run, &job, input_len);
+    lz4_check(job.ret, "Compression");
+    rb_str_set_len(result, (long)job.ret);
+    RB_GC_GUARD(input);
     return result;
 }
 
+/*
+ * Decompress LZ4 frame data (concatenated frames are decoded in sequence)
+ *
+ * @param data [String] LZ4-compressed data
+ * @param max_size [Integer] maximum decompressed size (keyword, default 100MB)
+ * @return [String] Decompressed data
+ * @raise [RuntimeError] if decompression fails or exceeds max_size
+ */
+VALUE konpeito_compression_lz4_decompress(int argc, VALUE *argv, VALUE self) {
+    VALUE data, opts;
+    rb_scan_args(argc, argv, "1:", &data, &opts);
+    Check_Type(data, T_STRING);
+    VALUE max_size = Qnil;
+    if (!NIL_P(opts)) {
+        VALUE val;
+        rb_get_kwargs(opts, &id_max_size, 0, 1, &val);
+        if (val != Qundef) max_size = val;
+    }
+    size_t max_output = codec_max_output(max_size);
+
+    VALUE pinned = compression_pin(data);
+    const char *input = RSTRING_PTR(pinned);
+    size_t input_len = RSTRING_LEN(pinned);
+    LZ4F_dctx *dctx = lz4_dctx();
+    LZ4F_resetDecompressionContext(dctx);
+
+    /* Reading the frame header consumes it */
+    LZ4F_frameInfo_t info;
+    size_t pos = input_len;
+    lz4_check(LZ4F_getFrameInfo(dctx, &info, input, &pos), "Decompression");
+
+    size_t capa = codec_initial_output(input_len, info.contentSize, max_output);
+    VALUE result = rb_str_buf_new((long)capa);
+    lz4_decompress_job_t job;
+    job.dctx = dctx;
+    job.src = input;
+    job.src_len = input_len;
+    job.src_pos = pos;
+    job.ret = 1;
+    while (1) {
+        if ((size_t)RSTRING_LEN(result) == capa) {
+            codec_output_grow(result, &capa, max_output);
+        }
+        job.dst = RSTRING_PTR(result);
+        job.dst_capa = capa;
+        job.dst_len = RSTRING_LEN(result);
+        compression_call(lz4_decompress_run, &job, input_len);
+        lz4_check(job.ret, "Decompression");
+        rb_str_set_len(result, (long)job.dst_len);
+        if (job.src_pos == job.src_len && job.ret == 0) break;
+        if (job.dst_len < capa) {
+            rb_raise(rb_eRuntimeError, "Decompression failed: truncated lz4 data");
+        }
+    }
+    RB_GC_GUARD(pinned);
+    return result;
+}
+#endif
+
 /* Module initialization */
 void Init_konpeito_compression(void) {
     VALUE mKonpeitoCompression = rb_define_module("KonpeitoCompression");
@@ -412,4 +1698,56 @@ void Init_konpeito_compression(void) {
     rb_define_const(mKonpeitoCompression, "BEST_SPEED", INT2FIX(Z_BEST_SPEED));
     rb_define_const(mKonpeitoCompression, "BEST_COMPRESSION", INT2FIX(Z_BEST_COMPRESSION));
     rb_define_const(mKonpeitoCompression, "DEFAULT_COMPRESSION", INT2FIX(Z_DEFAULT_COMPRESSION));
+
+    /* Parallel gzip */
+    id_level = rb_intern("level");
+    id_threads = rb_intern("threads");
+    rb_define_module_function(mKonpeitoCompression, "gzip_parallel", konpeito_compression_gzip_parallel, -1);
+
+#if defined(HAVE_ZSTD_H) || defined(HAVE_LZ4FRAME_H)
+#ifndef _WIN32
+    pthread_key_create(&codec_contexts_key, codec_contexts_free);
+#endif
+    id_max_size = rb_intern("max_size");
+#endif
+
+#ifdef HAVE_ZSTD_H
+    /* zstd (optional, see extconf.rb) */
+    id_dict = rb_intern("dict");
+    id_size = rb_intern("size");
+    rb_define_module_function(mKonpeitoCompression, "zstd_compress", konpeito_compression_zstd_compress, -1);
+    rb_define_module_function(mKonpeitoCompression, "zstd_decompress", konpeito_compression_zstd_decompress, -1);
+    rb_define_module_function(mKonpeitoCompression, "zstd_train_dictionary", konpeito_compression_zstd_train_dictionary, -1);
+    cZstdDictionary = rb_define_class_under(mKonpeitoCompression, "ZstdDictionary", rb_cObject);
+    rb_define_alloc_func(cZstdDictionary, zstd_dictionary_alloc);
+    rb_define_method(cZstdDictionary, "initialize", zstd_dictionary_initialize, -1);
+    rb_define_method(cZstdDictionary, "id", zstd_dictionary_id, 0);
+#endif
+
+#ifdef HAVE_LZ4FRAME_H
+    /* lz4 (optional, see extconf.rb) */
+    rb_define_module_function(mKonpeitoCompression, "lz4_compress", konpeito_compression_lz4_compress, -1);
+    rb_define_module_function(mKonpeitoCompression, "lz4_decompress", konpeito_compression_lz4_decompress, -1);
+#endif
+
+    id_write = rb_intern("write");
+    id_read = rb_intern("read");
+
+    /* Streaming gzip */
+    VALUE cGzipWriter = rb_define_class_under(mKonpeitoCompression, "GzipWriter", rb_cObject);
+    rb_define_alloc_func(cGzipWriter, gzip_writer_alloc);
+    rb_define_method(cGzipWriter, "initialize", gzip_writer_initialize, -1);
+    rb_define_method(cGzipWriter, "write", gzip_writer_write, 1);
+    rb_define_method(cGzipWriter, "<<", gzip_writer_append, 1);
+    rb_define_method(cGzipWriter, "flush", gzip_writer_flush, 0);
+    rb_define_method(cGzipWriter, "finish", gzip_writer_finish, 0);
+    rb_define_method(cGzipWriter, "close", gzip_writer_close, 0);
+
+    VALUE cGzipReader = rb_define_class_under(mKonpeitoCompression, "GzipReader", rb_cObject);
+    rb_define_alloc_func(cGzipReader, gzip_reader_alloc);
+    rb_define_method(cGzipReader, "initialize", gzip_reader_initialize, 1);
+    rb_define_method(cGzipReader, "read", gzip_reader_read, -1);
+    rb_define_method(cGzipReader, "each_chunk", gzip_reader_each_chunk, 0);
+    rb_define_method(cGzipReader, "eof?", gzip_reader_eof_p, 0);
+    rb_define_method(cGzipReader, "close", gzip_reader_close, 0);
 }
@@ -13,6 +13,20 @@ unless have_library('z') && have_header('zlib.h')
   MSG
 end
 
+# Optional codecs: zstd_* and lz4_* are only defined when these are found
+#   macOS:   brew install zstd lz4
+#   Ubuntu:  sudo apt-get install libzstd-dev liblz4-dev
+#   Fedora:  sudo dnf install libzstd-devel lz4-devel
+if have_library('zstd', 'ZDICT_trainFromBuffer', 'zdict.h')
+  have_header('zstd.h')
+end
+if have_library('lz4', 'LZ4F_compressBegin', 'lz4frame.h')
+  have_header('lz4frame.h')
+end
+
+# gzip_parallel compresses blocks on a pthread pool
+have_library('pthread')
+
 # Optimization flags
 $CFLAGS << ' -O3'
 
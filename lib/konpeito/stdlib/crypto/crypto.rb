@@ -16,6 +16,15 @@
 #   # HMAC for message authentication
 #   mac = KonpeitoCrypto.hmac_sha256("secret-key", "message to authenticate")
 #
+#   # Incremental hashing (large files, streams)
+#   KonpeitoCrypto::SHA256.file("backup.tar").hexdigest
+#   digest = KonpeitoCrypto::SHA256.new
+#   io.each_chunk { |chunk| digest << chunk }
+#   digest.hexdigest
+#
+#   # Many small messages in one call
+#   KonpeitoCrypto.sha256_many(keys)  # => Array of hex digests
+#
 #   # Secure random bytes
 #   bytes = KonpeitoCrypto.random_bytes(32)  # 32 random bytes
 #   hex = KonpeitoCrypto.random_hex(16)      # 32 character hex string
@@ -78,6 +87,59 @@ rescue LoadError => e
         a.bytes.zip(b.bytes) { |x, y| result |= x ^ y }
         result == 0
       end
+
+      def sha256_many(messages, binary: false)
+        messages.map { |m| binary ? sha256_binary(m) : sha256(m) }
+      end
+
+      def sha512_many(messages, binary: false)
+        messages.map { |m| binary ? sha512_binary(m) : sha512(m) }
+      end
+    end
+
+    class SHA256
+      ALGORITHM = 'SHA256'
+
+      def self.file(path)
+        new.file(path)
+      end
+
+      def initialize(data = nil)
+        @digest = OpenSSL::Digest.new(self.class::ALGORITHM)
+        update(data) if data
+      end
+
+      def update(data)
+        @digest.update(data)
+        self
+      end
+      alias << update
+
+      def file(path)
+        File.open(path, 'rb') do |f|
+          while (chunk = f.read(1024 * 1024))
+            @digest.update(chunk)
+          end
+        end
+        self
+      end
+
+      def digest
+        @digest.digest
+      end
+
+      def hexdigest
+        @digest.hexdigest
+      end
+
+      def reset
+        @digest.reset
+        self
+      end
+    end
+
+    class SHA512 < SHA256
+      ALGORITHM = 'SHA512'
     end
   end
 
@@ -6,32 +6,98 @@
  */
 
 #include <ruby.h>
+#include <ruby/thread.h>
 #include <openssl/sha.h>
 #include <openssl/hmac.h>
 #include <openssl/rand.h>
 #include <openssl/evp.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <string.h>
+#include <unistd.h>
 
 /*
  * Convert binary data to hex string
  */
 static VALUE binary_to_hex(const unsigned char *data, size_t len) {
-    char *hex = malloc(len * 2 + 1);
-    if (!hex) {
-        rb_raise(rb_eNoMemError, "Failed to allocate hex string");
-        return Qnil;
-    }
+    static const char digits[] = "0123456789abcdef";
+    VALUE result = rb_utf8_str_new(NULL, (long)(len * 2));
+    char *hex = RSTRING_PTR(result);
 
     for (size_t i = 0; i < len; i++) {
-        sprintf(hex + i * 2, "%02x", data[i]);
+        hex[i * 2] = digits[data[i] >> 4];
+        hex[i * 2 + 1] = digits[data[i] & 0x0f];
     }
-    hex[len * 2] = '\0';
-
-    VALUE result = rb_utf8_str_new(hex, len * 2);
-    free(hex);
     return result;
 }
 
+/*
+ * Inputs at least this large are hashed without the GVL, so other Ruby
+ * threads keep running. The Strings are pinned with frozen snapshots for
+ * the duration; below the threshold the handoff costs more than it frees.
+ */
+#define CRYPTO_NOGVL_MIN_SIZE (32 * 1024)
+
+typedef struct {
+    const EVP_MD *md;
+    const unsigned char *key;   /* NULL for a plain digest */
+    size_t key_len;
+    const unsigned char *data;
+    size_t data_len;
+    unsigned char out[EVP_MAX_MD_SIZE];
+    unsigned int out_len;
+    int ok;
+} crypto_digest_job_t;
+
+/* Runs without the GVL: only OpenSSL */
+static void *crypto_digest_run(void *arg) {
+    crypto_digest_job_t *job = (crypto_digest_job_t *)arg;
+    if (job->key) {
+        job->ok = HMAC(job->md, job->key, (int)job->key_len, job->data, job->data_len,
+                       job->out, &job->out_len) != NULL;
+    } else {
+        job->ok = EVP_Digest(job->data, job->data_len, job->out, &job->out_len, job->md, NULL) == 1;
+    }
+    return NULL;
+}
+
+/*
+ * Digest (key nil) or HMAC of data into job->out
+ *
+ * @raise [RuntimeError] if OpenSSL fails
+ */
+static void crypto_digest(crypto_digest_job_t *job, const EVP_MD *md, VALUE key, VALUE data) {
+    if (!NIL_P(key)) Check_Type(key, T_STRING);
+    Check_Type(data, T_STRING);
+
+    int nogvl = RSTRING_LEN(data) >= CRYPTO_NOGVL_MIN_SIZE;
+    if (nogvl) {
+        data = rb_str_new_frozen(data);
+        if (!NIL_P(key)) key = rb_str_new_frozen(key);
+    }
+
+    memset(job, 0, sizeof(*job));
+    job->md = md;
+    if (!NIL_P(key)) {
+        job->key = (const unsigned char *)RSTRING_PTR(key);
+        job->key_len = RSTRING_LEN(key);
+    }
+    job->data = (const unsigned char *)RSTRING_PTR(data);
+    job->data_len = RSTRING_LEN(data);
+
+    if (nogvl) {
+        rb_thread_call_without_gvl(crypto_digest_run, job, NULL, NULL);
+    } else {
+        crypto_digest_run(job);
+    }
+    RB_GC_GUARD(key);
+    RB_GC_GUARD(data);
+
+    if (!job->ok) {
+        rb_raise(rb_eRuntimeError, "Digest computation failed");
+    }
+}
+
 /*
  * Compute SHA256 hash
  *
@@ -39,15 +105,10 @@ static VALUE binary_to_hex(const unsigned char *data, size_t len) {
  * @return [String] Hex-encoded SHA256 hash (64 characters)
  */
 VALUE konpeito_crypto_sha256(VALUE self, VALUE data) {
-    Check_Type(data, T_STRING);
-
-    const unsigned char *input = (const unsigned char *)RSTRING_PTR(data);
-    size_t input_len = RSTRING_LEN(data);
+    crypto_digest_job_t job;
+    crypto_digest(&job, EVP_sha256(), Qnil, data);
 
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256(input, input_len, hash);
-
-    return binary_to_hex(hash, SHA256_DIGEST_LENGTH);
+    return binary_to_hex(job.out, job.out_len);
 }
 
 /*
@@ -57,15 +118,10 @@ VALUE konpeito_crypto_sha256(VALUE self, VALUE data) {
  * @return [String] Binary SHA256 hash (32 bytes)
  */
 VALUE konpeito_crypto_sha256_binary(VALUE self, VALUE data) {
-    Check_Type(data, T_STRING);
-
-    const unsigned char *input = (const unsigned char *)RSTRING_PTR(data);
-    size_t input_len = RSTRING_LEN(data);
+    crypto_digest_job_t job;
+    crypto_digest(&job, EVP_sha256(), Qnil, data);
 
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256(input, input_len, hash);
-
-    return rb_str_new((const char *)hash, SHA256_DIGEST_LENGTH);
+    return rb_str_new((const char *)job.out, job.out_len);
 }
 
 /*
@@ -75,15 +131,10 @@ VALUE konpeito_crypto_sha256_binary(VALUE self, VALUE data) {
  * @return [String] Hex-encoded SHA512 hash (128 characters)
  */
 VALUE konpeito_crypto_sha512(VALUE self, VALUE data) {
-    Check_Type(data, T_STRING);
+    crypto_digest_job_t job;
+    crypto_digest(&job, EVP_sha512(), Qnil, data);
 
-    const unsigned char *input = (const unsigned char *)RSTRING_PTR(data);
-    size_t input_len = RSTRING_LEN(data);
-
-    unsigned char hash[SHA512_DIGEST_LENGTH];
-    SHA512(input, input_len, hash);
-
-    return binary_to_hex(hash, SHA512_DIGEST_LENGTH);
+    return binary_to_hex(job.out, job.out_len);
 }
 
 /*
@@ -93,15 +144,10 @@ VALUE konpeito_crypto_sha512(VALUE self, VALUE data) {
  * @return [String] Binary SHA512 hash (64 bytes)
  */
 VALUE konpeito_crypto_sha512_binary(VALUE self, VALUE data) {
-    Check_Type(data, T_STRING);
-
-    const unsigned char *input = (const unsigned char *)RSTRING_PTR(data);
-    size_t input_len = RSTRING_LEN(data);
-
-    unsigned char hash[SHA512_DIGEST_LENGTH];
-    SHA512(input, input_len, hash);
+    crypto_digest_job_t job;
+    crypto_digest(&job, EVP_sha512(), Qnil, data);
 
-    return rb_str_new((const char *)hash, SHA512_DIGEST_LENGTH);
+    return rb_str_new((const char *)job.out, job.out_len);
 }
 
 /*
@@ -113,19 +159,11 @@ VALUE konpeito_crypto_sha512_binary(VALUE self, VALUE data) {
  */
 VALUE konpeito_crypto_hmac_sha256(VALUE self, VALUE key, VALUE data) {
     Check_Type(key, T_STRING);
-    Check_Type(data, T_STRING);
-
-    const unsigned char *key_ptr = (const unsigned char *)RSTRING_PTR(key);
-    size_t key_len = RSTRING_LEN(key);
-    const unsigned char *data_ptr = (const unsigned char *)RSTRING_PTR(data);
-    size_t data_len = RSTRING_LEN(data);
 
-    unsigned char result[EVP_MAX_MD_SIZE];
-    unsigned int result_len;
+    crypto_digest_job_t job;
+    crypto_digest(&job, EVP_sha256(), key, data);
 
-    HMAC(EVP_sha256(), key_ptr, (int)key_len, data_ptr, data_len, result, &result_len);
-
-    return binary_to_hex(result, result_len);
+    return binary_to_hex(job.out, job.out_len);
 }
 
 /*
@@ -137,19 +175,11 @@ VALUE konpeito_crypto_hmac_sha256(VALUE self, VALUE key, VALUE data) {
  */
 VALUE konpeito_crypto_hmac_sha256_binary(VALUE self, VALUE key, VALUE data) {
     Check_Type(key, T_STRING);
-    Check_Type(data, T_STRING);
 
-    const unsigned char *key_ptr = (const unsigned char *)RSTRING_PTR(key);
-    size_t key_len = RSTRING_LEN(key);
-    const unsigned char *data_ptr = (const unsigned char *)RSTRING_PTR(data);
-    size_t data_len = RSTRING_LEN(data);
+    crypto_digest_job_t job;
+    crypto_digest(&job, EVP_sha256(), key, data);
 
-    unsigned char result[EVP_MAX_MD_SIZE];
-    unsigned int result_len;
-
-    HMAC(EVP_sha256(), key_ptr, (int)key_len, data_ptr, data_len, result, &result_len);
-
-    return rb_str_new((const char *)result, result_len);
+    return rb_str_new((const char *)job.out, job.out_len);
 }
 
 /*
@@ -161,19 +191,404 @@ VALUE konpeito_crypto_hmac_sha256_binary(VALUE self, VALUE key, VALUE data) {
  */
 VALUE konpeito_crypto_hmac_sha512(VALUE self, VALUE key, VALUE data) {
     Check_Type(key, T_STRING);
-    Check_Type(data, T_STRING);
 
-    const unsigned char *key_ptr = (const unsigned char *)RSTRING_PTR(key);
-    size_t key_len = RSTRING_LEN(key);
-    const unsigned char *data_ptr = (const unsigned char *)RSTRING_PTR(data);
-    size_t data_len = RSTRING_LEN(data);
+    crypto_digest_job_t job;
+    crypto_digest(&job, EVP_sha512(), key, data);
+
+    return binary_to_hex(job.out, job.out_len);
+}
+
+/*
+ * Hash many messages in one call
+ *
+ * The messages are copied back to back into one buffer and hashed with a
+ * single reused EVP_MD_CTX, without the GVL once they add up to 32KB.
+ * This saves the per-call method dispatch, context setup and temporary
+ * allocations of calling sha256 in a loop.
+ */
+typedef struct {
+    const EVP_MD *md;
+    const unsigned char *data;  /* messages back to back */
+    const size_t *lens;
+    long count;
+    unsigned char *out;         /* count * digest size */
+    int ok;
+} crypto_many_job_t;
+
+static void *crypto_many_run(void *arg) {
+    crypto_many_job_t *job = (crypto_many_job_t *)arg;
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    if (!ctx) return NULL;
+
+    size_t size = (size_t)EVP_MD_size(job->md);
+    const unsigned char *p = job->data;
+    job->ok = 1;
+    for (long i = 0; i < job->count; i++) {
+        if (EVP_DigestInit_ex(ctx, job->md, NULL) != 1 ||
+            EVP_DigestUpdate(ctx, p, job->lens[i]) != 1 ||
+            EVP_DigestFinal_ex(ctx, job->out + i * size, NULL) != 1) {
+            job->ok = 0;
+            break;
+        }
+        p += job->lens[i];
+    }
+    EVP_MD_CTX_free(ctx);
+    return NULL;
+}
+
+static ID id_binary;
+
+static VALUE crypto_digest_many(int argc, VALUE *argv, const EVP_MD *md) {
+    VALUE messages, opts;
+    rb_scan_args(argc, argv, "1:", &messages, &opts);
+    Check_Type(messages, T_ARRAY);
+    int binary = 0;
+    if (!NIL_P(opts)) {
+        VALUE val;
+        rb_get_kwargs(opts, &id_binary, 0, 1, &val);
+        binary = val != Qundef && RTEST(val);
+    }
+
+    long count = RARRAY_LEN(messages);
+    size_t total = 0;
+    for (long i = 0; i < count; i++) {
+        VALUE msg = RARRAY_AREF(messages, i);
+        Check_Type(msg, T_STRING);
+        total += RSTRING_LEN(msg);
+    }
+
+    /* Private copies: nothing the workers read can move or change */
+    VALUE data = rb_str_buf_new((long)total);
+    VALUE lens_buf = rb_str_buf_new((long)(sizeof(size_t) * (count > 0 ? count : 1)));
+    size_t *lens = (size_t *)RSTRING_PTR(lens_buf);
+    for (long i = 0; i < count; i++) {
+        VALUE msg = RARRAY_AREF(messages, i);
+        rb_str_buf_cat(data, RSTRING_PTR(msg), RSTRING_LEN(msg));
+        lens[i] = RSTRING_LEN(msg);
+    }
+
+    size_t size = (size_t)EVP_MD_size(md);
+    VALUE out = rb_str_buf_new((long)(size * (count > 0 ? count : 1)));
+
+    crypto_many_job_t job;
+    job.md = md;
+    job.data = (const unsigned char *)RSTRING_PTR(data);
+    job.lens = lens;
+    job.count = count;
+    job.out = (unsigned char *)RSTRING_PTR(out);
+    job.ok = 0;
+    if (total >= CRYPTO_NOGVL_MIN_SIZE) {
+        rb_thread_call_without_gvl(crypto_many_run, &job, NULL, NULL);
+    } else {
+        crypto_many_run(&job);
+    }
+    if (!job.ok) {
+        rb_raise(rb_eRuntimeError, "Digest computation failed");
+    }
+
+    VALUE result = rb_ary_new_capa(count);
+    for (long i = 0; i < count; i++) {
+        const unsigned char *digest = job.out + i * size;
+        rb_ary_push(result, binary ? rb_str_new((const char *)digest, (long)size)
+                                   : binary_to_hex(digest, size));
+    }
+    RB_GC_GUARD(data);
+    RB_GC_GUARD(lens_buf);
+    RB_GC_GUARD(out);
+    return result;
+}
+
+/*
+ * Compute the SHA256 of each message
+ *
+ * @param messages [Array<String>] Messages to hash
+ * @param binary [Boolean] return 32-byte binary digests (keyword, default: hex)
+ * @return [Array<String>] Digests, in the order of messages
+ */
+VALUE konpeito_crypto_sha256_many(int argc, VALUE *argv, VALUE self) {
+    return crypto_digest_many(argc, argv, EVP_sha256());
+}
+
+/*
+ * Compute the SHA512 of each message
+ *
+ * @param messages [Array<String>] Messages to hash
+ * @param binary [Boolean] return 64-byte binary digests (keyword, default: hex)
+ * @return [Array<String>] Digests, in the order of messages
+ */
+VALUE konpeito_crypto_sha512_many(int argc, VALUE *argv, VALUE self) {
+    return crypto_digest_many(argc, argv, EVP_sha512());
+}
+
+/*
+ * Incremental digests: KonpeitoCrypto::SHA256 / SHA512
+ *
+ * Data is fed with update in any number of pieces, so large inputs never
+ * need to be held in memory at once; digest/hexdigest finalize a copy of
+ * the context and can be called at any point.
+ */
+
+/* Files are read and hashed in blocks of this size */
+#define CRYPTO_FILE_CHUNK_SIZE (1024 * 1024)
+
+typedef struct {
+    EVP_MD_CTX *ctx;
+    const EVP_MD *md;
+    int in_use;     /* a thread is hashing without the GVL */
+} crypto_hasher_t;
+
+static void crypto_hasher_free(void *ptr) {
+    crypto_hasher_t *h = (crypto_hasher_t *)ptr;
+    EVP_MD_CTX_free(h->ctx);
+    ruby_xfree(h);
+}
+
+static const rb_data_type_t crypto_hasher_type = {
+    "KonpeitoCrypto::Digest",
+    { NULL, crypto_hasher_free, NULL, },
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE crypto_hasher_alloc(VALUE klass, const EVP_MD *md) {
+    crypto_hasher_t *h;
+    VALUE obj = TypedData_Make_Struct(klass, crypto_hasher_t, &crypto_hasher_type, h);
+    h->md = md;
+    h->ctx = EVP_MD_CTX_new();
+    if (!h->ctx || EVP_DigestInit_ex(h->ctx, md, NULL) != 1) {
+        rb_raise(rb_eRuntimeError, "Failed to initialize digest");
+    }
+    return obj;
+}
+
+static VALUE crypto_sha256_alloc(VALUE klass) {
+    return crypto_hasher_alloc(klass, EVP_sha256());
+}
+
+static VALUE crypto_sha512_alloc(VALUE klass) {
+    return crypto_hasher_alloc(klass, EVP_sha512());
+}
+
+static crypto_hasher_t *crypto_hasher_get(VALUE self) {
+    crypto_hasher_t *h;
+    TypedData_Get_Struct(self, crypto_hasher_t, &crypto_hasher_type, h);
+    if (h->in_use) {
+        rb_raise(rb_eRuntimeError, "digest is in use by another thread");
+    }
+    return h;
+}
+
+typedef struct {
+    EVP_MD_CTX *ctx;
+    const void *data;
+    size_t len;
+    int ok;
+} crypto_update_job_t;
+
+static void *crypto_update_run(void *arg) {
+    crypto_update_job_t *job = (crypto_update_job_t *)arg;
+    job->ok = EVP_DigestUpdate(job->ctx, job->data, job->len) == 1;
+    return NULL;
+}
+
+static VALUE crypto_update_nogvl(VALUE arg) {
+    rb_thread_call_without_gvl(crypto_update_run, (void *)arg, NULL, NULL);
+    return Qnil;
+}
 
-    unsigned char result[EVP_MAX_MD_SIZE];
-    unsigned int result_len;
+/* Cleared in an ensure: the interrupt check after the no-GVL update can raise */
+static VALUE crypto_hasher_release(VALUE arg) {
+    ((crypto_hasher_t *)arg)->in_use = 0;
+    return Qnil;
+}
 
-    HMAC(EVP_sha512(), key_ptr, (int)key_len, data_ptr, data_len, result, &result_len);
+static void crypto_hasher_update(crypto_hasher_t *h, const void *data, size_t len) {
+    crypto_update_job_t job = { h->ctx, data, len, 0 };
+    if (len >= CRYPTO_NOGVL_MIN_SIZE) {
+        h->in_use = 1;
+        rb_ensure(crypto_update_nogvl, (VALUE)&job, crypto_hasher_release, (VALUE)h);
+    } else {
+        crypto_update_run(&job);
+    }
+    if (!job.ok) {
+        rb_raise(rb_eRuntimeError, "Digest computation failed");
+    }
+}
 
-    return binary_to_hex(result, result_len);
+/*
+ * Feed data into the digest
+ *
+ * @param data [String] Data to hash
+ * @return [self]
+ */
+static VALUE crypto_hasher_update_m(VALUE self, VALUE data) {
+    crypto_hasher_t *h = crypto_hasher_get(self);
+    StringValue(data);
+    if (RSTRING_LEN(data) >= CRYPTO_NOGVL_MIN_SIZE) {
+        data = rb_str_new_frozen(data);
+    }
+    crypto_hasher_update(h, RSTRING_PTR(data), RSTRING_LEN(data));
+    RB_GC_GUARD(data);
+    return self;
+}
+
+/*
+ * @param data [String, nil] Initial data
+ */
+static VALUE crypto_hasher_initialize(int argc, VALUE *argv, VALUE self) {
+    VALUE data;
+    rb_scan_args(argc, argv, "01", &data);
+    if (!NIL_P(data)) {
+        crypto_hasher_update_m(self, data);
+    }
+    return self;
+}
+
+typedef struct {
+    int fd;
+    unsigned char *buf;
+    crypto_hasher_t *hasher;
+    VALUE path;
+} crypto_file_args_t;
+
+typedef struct {
+    int fd;
+    unsigned char *buf;
+    EVP_MD_CTX *ctx;
+    ssize_t nread;
+    int err;
+    int ok;
+} crypto_read_job_t;
+
+/* Read one block and hash it */
+static void *crypto_read_run(void *arg) {
+    crypto_read_job_t *job = (crypto_read_job_t *)arg;
+    do {
+        job->nread = read(job->fd, job->buf, CRYPTO_FILE_CHUNK_SIZE);
+    } while (job->nread < 0 && errno == EINTR);
+    job->err = job->nread < 0 ? errno : 0;
+    job->ok = job->nread <= 0 || EVP_DigestUpdate(job->ctx, job->buf, (size_t)job->nread) == 1;
+    return NULL;
+}
+
+/* Read and hash one block per GVL release, checking for interrupts between blocks */
+static VALUE crypto_file_body(VALUE arg) {
+    crypto_file_args_t *args = (crypto_file_args_t *)arg;
+    crypto_read_job_t job = { args->fd, args->buf, args->hasher->ctx, 0, 0, 0 };
+    while (1) {
+        rb_thread_call_without_gvl(crypto_read_run, &job, NULL, NULL);
+        if (job.nread < 0) {
+            errno = job.err;
+            rb_sys_fail_str(args->path);
+        }
+        if (!job.ok) {
+            rb_raise(rb_eRuntimeError, "Digest computation failed");
+        }
+        if (job.nread == 0) break;
+        rb_thread_check_ints();
+    }
+    return Qnil;
+}
+
+static VALUE crypto_file_ensure(VALUE arg) {
+    crypto_file_args_t *args = (crypto_file_args_t *)arg;
+    close(args->fd);
+    ruby_xfree(args->buf);
+    args->hasher->in_use = 0;
+    return Qnil;
+}
+
+/*
+ * Feed the contents of a file into the digest, 1MB at a time
+ *
+ * @param path [String] File to hash
+ * @return [self]
+ * @raise [SystemCallError] if the file cannot be read
+ */
+static VALUE crypto_hasher_file(VALUE self, VALUE path) {
+    crypto_hasher_t *h = crypto_hasher_get(self);
+    FilePathValue(path);
+
+    int fd = open(RSTRING_PTR(path), O_RDONLY);
+    if (fd < 0) {
+        rb_sys_fail_str(path);
+    }
+
+    crypto_file_args_t args;
+    args.fd = fd;
+    args.buf = ruby_xmalloc(CRYPTO_FILE_CHUNK_SIZE);
+    args.hasher = h;
+    args.path = path;
+    /* Held for the whole file: other threads must not update the context between blocks */
+    h->in_use = 1;
+    rb_ensure(crypto_file_body, (VALUE)&args, crypto_file_ensure, (VALUE)&args);
+    return self;
+}
+
+/*
+ * Digest of a whole file, e.g. KonpeitoCrypto::SHA256.file(path).hexdigest
+ *
+ * @param path [String] File to hash
+ * @return [KonpeitoCrypto::SHA256, KonpeitoCrypto::SHA512] New digest fed with the file
+ */
+static VALUE crypto_hasher_s_file(VALUE klass, VALUE path) {
+    VALUE obj = rb_class_new_instance(0, NULL, klass);
+    return crypto_hasher_file(obj, path);
+}
+
+/* Finalize a copy so the digest can keep being updated */
+static unsigned int crypto_hasher_final(crypto_hasher_t *h, unsigned char *out) {
+    unsigned int len = 0;
+    EVP_MD_CTX *copy = EVP_MD_CTX_new();
+    int ok = copy && EVP_MD_CTX_copy_ex(copy, h->ctx) == 1 && EVP_DigestFinal_ex(copy, out, &len) == 1;
+    EVP_MD_CTX_free(copy);
+    if (!ok) {
+        rb_raise(rb_eRuntimeError, "Digest computation failed");
+    }
+    return len;
+}
+
+/*
+ * @return [String] Binary digest of the data so far
+ */
+static VALUE crypto_hasher_digest(VALUE self) {
+    crypto_hasher_t *h = crypto_hasher_get(self);
+    unsigned char out[EVP_MAX_MD_SIZE];
+    unsigned int len = crypto_hasher_final(h, out);
+    return rb_str_new((const char *)out, len);
+}
+
+/*
+ * @return [String] Hex-encoded digest of the data so far
+ */
+static VALUE crypto_hasher_hexdigest(VALUE self) {
+    crypto_hasher_t *h = crypto_hasher_get(self);
+    unsigned char out[EVP_MAX_MD_SIZE];
+    unsigned int len = crypto_hasher_final(h, out);
+    return binary_to_hex(out, len);
+}
+
+/*
+ * Start over with no data
+ *
+ * @return [self]
+ */
+static VALUE crypto_hasher_reset(VALUE self) {
+    crypto_hasher_t *h = crypto_hasher_get(self);
+    if (EVP_DigestInit_ex(h->ctx, h->md, NULL) != 1) {
+        rb_raise(rb_eRuntimeError, "Failed to initialize digest");
+    }
+    return self;
+}
+
+static void crypto_define_hasher(VALUE klass) {
+    rb_define_method(klass, "initialize", crypto_hasher_initialize, -1);
+    rb_define_method(klass, "update", crypto_hasher_update_m, 1);
+    rb_define_method(klass, "<<", crypto_hasher_update_m, 1);
+    rb_define_method(klass, "file", crypto_hasher_file, 1);
+    rb_define_method(klass, "digest", crypto_hasher_digest, 0);
+    rb_define_method(klass, "hexdigest", crypto_hasher_hexdigest, 0);
+    rb_define_method(klass, "reset", crypto_hasher_reset, 0);
+    rb_define_singleton_method(klass, "file", crypto_hasher_s_file, 1);
 }
 
 /*
@@ -309,4 +724,18 @@ void Init_konpeito_crypto(void) {
 
     /* Utilities */
     rb_define_module_function(mKonpeitoCrypto, "secure_compare", konpeito_crypto_secure_compare, 2);
+
+    /* Batch hashing */
+    id_binary = rb_intern("binary");
+    rb_define_module_function(mKonpeitoCrypto, "sha256_many", konpeito_crypto_sha256_many, -1);
+    rb_define_module_function(mKonpeitoCrypto, "sha512_many", konpeito_crypto_sha512_many, -1);
+
+    /* Incremental digests */
+    VALUE cSHA256 = rb_define_class_under(mKonpeitoCrypto, "SHA256", rb_cObject);
+    rb_define_alloc_func(cSHA256, crypto_sha256_alloc);
+    crypto_define_hasher(cSHA256);
+
+    VALUE cSHA512 = rb_define_class_under(mKonpeitoCrypto, "SHA512", rb_cObject);
+    rb_define_alloc_func(cSHA512, crypto_sha512_alloc);
+    crypto_define_hasher(cSHA512);
 }
@@ -32,6 +32,21 @@
 #     '{"updated": true}',
 #     {"Authorization" => "Bearer token", "Content-Type" => "application/json"}
 #   )
+#
+#   # Client with persistent connections (DNS, TCP and TLS reused across calls);
+#   # bodies are compressed in transit and HTTP/2 is negotiated by default
+#   client = KonpeitoHTTP::Client.new(max_per_host: 8, compressed: true, http2: true)
+#   response = client.get("https://api.example.com/items/1")
+#   response = client.post("https://api.example.com/items", body, {"Content-Type" => "application/json"})
+#   client.close
+#
+#   # Concurrent requests, responses in input order (GVL released while waiting)
+#   responses = KonpeitoHTTP.request_all(urls, concurrency: 16)
+#   responses = client.request_all([{url: url, method: "POST", body: json}])
+#
+#   # Large bodies without buffering
+#   client.stream("GET", url) { |chunk| io.write(chunk) }
+#   client.download(url, "artifact.tar.gz")
 
 # Try to load the native extension
 begin
@@ -93,7 +108,16 @@ rescue LoadError => e
         uri = URI.parse(url)
         http = Net::HTTP.new(uri.host, uri.port)
         http.use_ssl = (uri.scheme == 'https')
+        perform(http, method, uri, body, headers)
+      end
+
+      def request_all(requests, concurrency: 16)
+        client = Client.new(max_per_host: concurrency, compressed: false, http2: false)
+        client.request_all(requests, concurrency: concurrency)
+      end
 
+      # Shared by request and Client#request
+      def perform(http, method, uri, body, headers)
         request_class = case method.upcase
         when 'GET' then Net::HTTP::Get
         when 'POST' then Net::HTTP::Post
@@ -119,6 +143,120 @@ rescue LoadError => e
         }
       end
     end
+
+    # Keeps one started Net::HTTP session per host
+    class Client
+      # net/http decodes gzip/deflate by itself and has no HTTP/2, so http2: is accepted and ignored
+      def initialize(max_per_host: 8, max_connections: 64, timeout: 30, connect_timeout: 10,
+                     compressed: true, http2: true)
+        raise ArgumentError, "connection limits must be positive" if max_per_host < 1 || max_connections < 1
+
+        @timeout = timeout
+        @connect_timeout = connect_timeout
+        @compressed = compressed
+        @sessions = {}
+      end
+
+      def request(method, url, body = nil, headers = nil)
+        uri = URI.parse(url)
+        KonpeitoHTTP.perform(session_for(uri), method, uri, body, with_encoding(headers))
+      end
+
+      def get(url, headers = nil)
+        request('GET', url, nil, headers)
+      end
+
+      def post(url, body, headers = nil)
+        request('POST', url, body, headers)
+      end
+
+      def stream(method, url, body = nil, headers = nil, &block)
+        raise ArgumentError, "no block given" unless block
+
+        each_body_chunk(method, url, body, headers, &block)
+      end
+
+      def download(url, path, headers = nil)
+        File.open(path, 'wb') do |file|
+          each_body_chunk('GET', url, nil, headers) { |chunk| file.write(chunk) }
+        end
+      end
+
+      # Threads with one Client each (Net::HTTP sessions are not thread-safe)
+      def request_all(requests, concurrency: 16)
+        raise ArgumentError, "concurrency must be positive" if concurrency < 1
+        raise IOError, "closed KonpeitoHTTP::Client" unless @sessions
+
+        results = Array.new(requests.size)
+        queue = Queue.new
+        requests.each_with_index { |spec, i| queue << [spec, i] }
+        queue.close
+        workers = Array.new([concurrency, requests.size].min) do
+          Thread.new do
+            client = Client.new(timeout: @timeout, connect_timeout: @connect_timeout, compressed: @compressed)
+            while (item = queue.pop)
+              spec, i = item
+              spec = {url: spec} if spec.is_a?(String)
+              results[i] = begin
+                client.request((spec[:method] || 'GET').to_s.upcase, spec[:url], spec[:body], spec[:headers])
+              rescue StandardError => e
+                {status: 0, body: nil, headers: {}, error: e.message}
+              end
+            end
+            client.close
+          end
+        end
+        workers.each(&:join)
+        results
+      end
+
+      def close
+        @sessions&.each_value(&:finish)
+        @sessions = nil
+      end
+
+      def closed?
+        @sessions.nil?
+      end
+
+      private
+
+      def with_encoding(headers)
+        @compressed ? headers : {'Accept-Encoding' => 'identity'}.merge(headers || {})
+      end
+
+      def session_for(uri)
+        raise IOError, "closed KonpeitoHTTP::Client" unless @sessions
+
+        @sessions[[uri.scheme, uri.host, uri.port]] ||= begin
+          session = Net::HTTP.new(uri.host, uri.port)
+          session.use_ssl = (uri.scheme == 'https')
+          session.read_timeout = @timeout
+          session.open_timeout = @connect_timeout
+          session.start
+        end
+      end
+
+      def each_body_chunk(method, url, body, headers)
+        uri = URI.parse(url)
+        request = Net::HTTPGenericRequest.new(method.upcase, !body.nil?, method.upcase != 'HEAD', uri.request_uri)
+        request.body = body if body
+        with_encoding(headers).each { |k, v| request[k] = v }
+
+        size = 0
+        response_headers = {}
+        status = nil
+        session_for(uri).request(request) do |response|
+          status = response.code.to_i
+          response.each_header { |k, v| response_headers[k] = v }
+          response.read_body do |chunk|
+            size += chunk.bytesize
+            yield chunk
+          end
+        end
+        {status: status, body: nil, size: size, headers: response_headers}
+      end
+    end
   end
 
   warn "KonpeitoHTTP: Native extension not available, using net/http fallback (#{e.message})"
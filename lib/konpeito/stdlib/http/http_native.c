@@ -6,7 +6,11 @@
  */
 
 #include <ruby.h>
+#include <ruby/encoding.h>
+#include <ruby/thread.h>
 #include <curl/curl.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -14,19 +18,43 @@
 typedef struct {
     char *data;
     size_t size;
+    size_t capa;
 } response_buffer_t;
 
+#define RESPONSE_BUFFER_INITIAL_CAPA (16 * 1024)
+
+/* Make room for len more bytes plus a NUL, doubling the capacity (0 on failure) */
+static int response_buffer_reserve(response_buffer_t *buf, size_t len) {
+    size_t need = buf->size + len + 1;
+    if (need <= buf->capa) {
+        return 1;
+    }
+    size_t capa = buf->capa > 0 ? buf->capa : RESPONSE_BUFFER_INITIAL_CAPA;
+    while (capa < need) {
+        if (capa > SIZE_MAX / 2) {
+            capa = need;
+            break;
+        }
+        capa *= 2;
+    }
+    char *ptr = realloc(buf->data, capa);
+    if (!ptr) {
+        return 0;
+    }
+    buf->data = ptr;
+    buf->capa = capa;
+    return 1;
+}
+
 /* Write callback for curl */
 static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
     size_t realsize = size * nmemb;
     response_buffer_t *buf = (response_buffer_t *)userp;
 
-    char *ptr = realloc(buf->data, buf->size + realsize + 1);
-    if (!ptr) {
+    if (!response_buffer_reserve(buf, realsize)) {
         return 0; /* out of memory */
     }
 
-    buf->data = ptr;
     memcpy(&(buf->data[buf->size]), contents, realsize);
     buf->size += realsize;
     buf->data[buf->size] = '\0';
@@ -34,19 +62,18 @@ static size_t write_callback(void *contents, size_t size, size_t nmemb, void *us
     return realsize;
 }
 
-/* Header write callback for curl */
-static size_t header_callback(char *buffer, size_t size, size_t nitems, void *userp) {
-    size_t realsize = size * nitems;
-    VALUE headers_hash = (VALUE)userp;
-
-    /* Parse header line: "Key: Value\r\n" */
-    char *colon = memchr(buffer, ':', realsize);
+/*
+ * Parse one header line ("Key: Value\r\n") into headers_hash; other lines
+ * are ignored. Header names are frozen, interned Strings.
+ */
+static void http_header_line_aset(VALUE headers_hash, const char *buffer, size_t realsize) {
+    const char *colon = memchr(buffer, ':', realsize);
     if (colon && colon > buffer) {
         size_t key_len = colon - buffer;
-        char *value_start = colon + 1;
+        const char *value_start = colon + 1;
 
         /* Skip leading whitespace in value */
-        while (*value_start == ' ' && value_start < buffer + realsize) {
+        while (value_start < buffer + realsize && *value_start == ' ') {
             value_start++;
         }
 
@@ -57,15 +84,295 @@ static size_t header_callback(char *buffer, size_t size, size_t nitems, void *us
         }
 
         if (value_len > 0) {
-            VALUE key = rb_utf8_str_new(buffer, key_len);
+            /* Names repeat on every response: use the frozen, deduplicated String */
+            VALUE key = rb_enc_interned_str(buffer, (long)key_len, rb_utf8_encoding());
             VALUE value = rb_utf8_str_new(value_start, value_len);
             rb_hash_aset(headers_hash, key, value);
         }
     }
+}
 
+/* Header write callback for curl */
+static size_t header_callback(char *buffer, size_t size, size_t nitems, void *userp) {
+    size_t realsize = size * nitems;
+    http_header_line_aset((VALUE)userp, buffer, realsize);
     return realsize;
 }
 
+/*
+ * Build the response header Hash from raw header lines collected during a
+ * transfer. Later lines (e.g. after a redirect) overwrite earlier ones, as
+ * with header_callback.
+ */
+static VALUE http_parse_headers(const response_buffer_t *raw) {
+    VALUE headers_hash = rb_hash_new();
+    const char *p = raw->data;
+    const char *end = p + raw->size;
+    while (p < end) {
+        const char *eol = memchr(p, '\n', end - p);
+        const char *next = eol ? eol + 1 : end;
+        http_header_line_aset(headers_hash, p, next - p);
+        p = next;
+    }
+    return headers_hash;
+}
+
+/*
+ * One request, copied into C memory, plus the raw response collected by the
+ * curl callbacks. Nothing here refers to Ruby objects, so a transfer can run
+ * without the GVL.
+ */
+typedef enum {
+    HTTP_SINK_BUFFER,                   /* collect the body for the response Hash */
+    HTTP_SINK_FILE,                     /* write the body to file */
+    HTTP_SINK_BLOCK                     /* yield the body in chunks to block */
+} http_sink_t;
+
+/* Body chunks are yielded once this many bytes have arrived */
+#define HTTP_STREAM_CHUNK_SIZE (64 * 1024)
+
+/* Content-Length pre-sizes the body buffer up to this; doubling covers the rest */
+#define HTTP_PRESIZE_MAX (64 * 1024 * 1024)
+
+typedef struct {
+    char *method;
+    char *url;
+    char *body;                         /* NULL when the request has no body */
+    size_t body_len;
+    struct curl_slist *headers_list;
+    CURL *curl;
+    response_buffer_t response;
+    response_buffer_t header_data;
+    long status;
+    CURLcode result;
+    int active;                         /* added to a multi handle */
+    http_sink_t sink;
+    FILE *file;
+    VALUE block;                        /* only touched with the GVL held */
+    int exc_state;                      /* the block raised (rb_protect state) */
+    size_t received;                    /* body bytes for the FILE and BLOCK sinks */
+} http_transfer_t;
+
+static char *http_strndup(const char *str, size_t len) {
+    char *copy = malloc(len + 1);
+    if (!copy) {
+        rb_memerror();
+    }
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+static VALUE http_stream_yield_chunk(VALUE arg) {
+    http_transfer_t *t = (http_transfer_t *)arg;
+    VALUE chunk = rb_str_new(t->response.data, t->response.size);
+    t->response.size = 0;
+    return rb_funcall(t->block, rb_intern("call"), 1, chunk);
+}
+
+/* Called with the GVL reacquired; an exception is kept and re-raised after the transfer */
+static void *http_stream_flush(void *arg) {
+    http_transfer_t *t = (http_transfer_t *)arg;
+    rb_protect(http_stream_yield_chunk, (VALUE)t, &t->exc_state);
+    return NULL;
+}
+
+/*
+ * Body callback for transfers. The buffered sink is pre-sized from
+ * Content-Length on the first chunk; the streaming sinks hold at most one
+ * chunk in memory. Returning less than realsize aborts the transfer.
+ */
+static size_t body_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    http_transfer_t *t = (http_transfer_t *)userp;
+
+    switch (t->sink) {
+    case HTTP_SINK_FILE:
+        t->received += realsize;
+        return fwrite(contents, 1, realsize, t->file);
+    case HTTP_SINK_BLOCK:
+        t->received += realsize;
+        if (write_callback(contents, size, nmemb, &t->response) != realsize) {
+            return 0;
+        }
+        if (t->response.size >= HTTP_STREAM_CHUNK_SIZE) {
+            rb_thread_call_with_gvl(http_stream_flush, t);
+            if (t->exc_state) {
+                return 0;
+            }
+        }
+        return realsize;
+    default:
+        if (t->response.capa == 0) {
+            curl_off_t length = -1;
+            curl_easy_getinfo(t->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+            if (length > 0) {
+                /* The header is the server's claim: never trust it for more than the cap */
+                response_buffer_reserve(&t->response,
+                                        length < HTTP_PRESIZE_MAX ? (size_t)length : HTTP_PRESIZE_MAX);
+            }
+        }
+        return write_callback(contents, size, nmemb, &t->response);
+    }
+}
+
+/*
+ * Append "name: value" to a header list, sized to fit (no truncation).
+ * CR and LF are rejected so a value cannot inject further headers.
+ */
+static struct curl_slist *http_header_append(struct curl_slist *list, VALUE name, VALUE value) {
+    const char *name_ptr = RSTRING_PTR(name);
+    const char *value_ptr = RSTRING_PTR(value);
+    long name_len = RSTRING_LEN(name);
+    long value_len = RSTRING_LEN(value);
+    if (memchr(name_ptr, ':', name_len) || memchr(name_ptr, '\r', name_len) || memchr(name_ptr, '\n', name_len) ||
+        memchr(value_ptr, '\r', value_len) || memchr(value_ptr, '\n', value_len) ||
+        memchr(name_ptr, '\0', name_len) || memchr(value_ptr, '\0', value_len)) {
+        rb_raise(rb_eArgError, "invalid HTTP header: %"PRIsVALUE, name);
+    }
+
+    char stack_buf[256];
+    size_t line_len = (size_t)name_len + 2 + (size_t)value_len;
+    char *line = line_len < sizeof(stack_buf) ? stack_buf : malloc(line_len + 1);
+    if (!line) {
+        rb_memerror();
+    }
+    memcpy(line, name_ptr, name_len);
+    line[name_len] = ':';
+    line[name_len + 1] = ' ';
+    memcpy(line + name_len + 2, value_ptr, value_len);
+    line[line_len] = '\0';
+
+    struct curl_slist *appended = curl_slist_append(list, line);
+    if (line != stack_buf) {
+        free(line);
+    }
+    if (!appended) {
+        rb_memerror();
+    }
+    return appended;
+}
+
+static int http_header_append_i(VALUE key, VALUE val, VALUE arg) {
+    http_transfer_t *t = (http_transfer_t *)arg;
+    t->headers_list = http_header_append(t->headers_list, rb_obj_as_string(key), rb_obj_as_string(val));
+    return ST_CONTINUE;
+}
+
+/* Validate a request and copy it into t (needs the GVL) */
+static void http_transfer_prepare(http_transfer_t *t, VALUE method, VALUE url, VALUE body, VALUE headers) {
+    Check_Type(method, T_STRING);
+    Check_Type(url, T_STRING);
+    if (!NIL_P(body)) Check_Type(body, T_STRING);
+    if (!NIL_P(headers)) Check_Type(headers, T_HASH);
+
+    /* Set custom headers */
+    if (!NIL_P(headers)) {
+        rb_hash_foreach(headers, http_header_append_i, (VALUE)t);
+    }
+
+    t->method = http_strndup(RSTRING_PTR(method), RSTRING_LEN(method));
+    t->url = http_strndup(RSTRING_PTR(url), RSTRING_LEN(url));
+    if (!NIL_P(body)) {
+        t->body = http_strndup(RSTRING_PTR(body), RSTRING_LEN(body));
+        t->body_len = RSTRING_LEN(body);
+    }
+}
+
+/* Transfer settings: the module functions use the defaults, a Client its own */
+typedef struct {
+    long timeout;
+    long connect_timeout;       /* 0 = libcurl default */
+    int compressed;             /* send Accept-Encoding and decode the body */
+    int http2;                  /* negotiate HTTP/2 over TLS, multiplex on one connection */
+} http_options_t;
+
+static const http_options_t http_default_options = { 30L, 0L, 0, 0 };
+
+/* Set every option of t on its easy handle (no GVL needed) */
+static void http_transfer_apply(http_transfer_t *t, const http_options_t *opts) {
+    CURL *curl = t->curl;
+
+    /* Set HTTP method */
+    if (strcmp(t->method, "GET") == 0) {
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    } else if (strcmp(t->method, "POST") == 0) {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    } else if (strcmp(t->method, "HEAD") == 0) {
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, t->method);
+    }
+
+    /* Set request body */
+    if (t->body) {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, t->body);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)t->body_len);
+    }
+
+    if (t->headers_list) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, t->headers_list);
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, t->url);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, body_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)t);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &t->header_data);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, opts->timeout);
+    if (opts->connect_timeout > 0) {
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, opts->connect_timeout);
+    }
+    if (opts->compressed) {
+        /* "" offers every encoding this libcurl can decode (gzip, deflate, br, zstd) */
+        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    }
+    if (opts->http2) {
+        /* h2 via ALPN on https (HTTP/1.1 on plain http); wait to share an h2 connection */
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    }
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Konpeito-HTTP/1.0");
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, (void *)t);
+}
+
+/*
+ * Build the {status:, body:, headers:} response Hash of a finished transfer
+ * (streamed bodies: body is nil and :size has the byte count)
+ */
+static VALUE http_transfer_response(http_transfer_t *t) {
+    VALUE result = rb_hash_new();
+    rb_hash_aset(result, ID2SYM(rb_intern("status")), LONG2NUM(t->status));
+    if (t->sink == HTTP_SINK_BUFFER) {
+        rb_hash_aset(result, ID2SYM(rb_intern("body")), rb_utf8_str_new(t->response.data, t->response.size));
+    } else {
+        rb_hash_aset(result, ID2SYM(rb_intern("body")), Qnil);
+        rb_hash_aset(result, ID2SYM(rb_intern("size")), SIZET2NUM(t->received));
+    }
+    rb_hash_aset(result, ID2SYM(rb_intern("headers")), http_parse_headers(&t->header_data));
+    return result;
+}
+
+/* Release everything t owns except the easy handle */
+static void http_transfer_free(http_transfer_t *t) {
+    free(t->method);
+    free(t->url);
+    free(t->body);
+    free(t->response.data);
+    free(t->header_data.data);
+    if (t->headers_list) {
+        curl_slist_free_all(t->headers_list);
+    }
+    if (t->file) {
+        fclose(t->file);
+    }
+    memset(t, 0, sizeof(*t));
+}
+
 /*
  * Perform HTTP GET request
  *
@@ -244,18 +551,22 @@ VALUE konpeito_http_post_response(VALUE self, VALUE url, VALUE body, VALUE conte
     const char *body_str = RSTRING_PTR(body);
     size_t body_len = RSTRING_LEN(body);
 
+    struct curl_slist *headers_list = NULL;
+    if (!NIL_P(content_type)) {
+        Check_Type(content_type, T_STRING);
+        headers_list = http_header_append(headers_list, rb_str_new_cstr("Content-Type"), content_type);
+    }
+
     CURL *curl = curl_easy_init();
     if (!curl) {
+        if (headers_list) {
+            curl_slist_free_all(headers_list);
+        }
         rb_raise(rb_eRuntimeError, "Failed to initialize curl");
         return Qnil;
     }
 
-    struct curl_slist *headers_list = NULL;
-    if (!NIL_P(content_type)) {
-        Check_Type(content_type, T_STRING);
-        char header_buf[256];
-        snprintf(header_buf, sizeof(header_buf), "Content-Type: %s", RSTRING_PTR(content_type));
-        headers_list = curl_slist_append(headers_list, header_buf);
+    if (headers_list) {
         curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_list);
     }
 
@@ -305,6 +616,40 @@ VALUE konpeito_http_post_response(VALUE self, VALUE url, VALUE body, VALUE conte
     return result;
 }
 
+typedef struct {
+    http_transfer_t t;
+    VALUE method, url, body, headers;
+} http_request_args_t;
+
+static VALUE http_request_body(VALUE arg) {
+    http_request_args_t *req = (http_request_args_t *)arg;
+    http_transfer_t *t = &req->t;
+    http_transfer_prepare(t, req->method, req->url, req->body, req->headers);
+
+    t->curl = curl_easy_init();
+    if (!t->curl) {
+        rb_raise(rb_eRuntimeError, "Failed to initialize curl");
+    }
+    http_transfer_apply(t, &http_default_options);
+
+    CURLcode res = curl_easy_perform(t->curl);
+    if (res != CURLE_OK) {
+        rb_raise(rb_eRuntimeError, "HTTP request failed: %s", curl_easy_strerror(res));
+    }
+
+    curl_easy_getinfo(t->curl, CURLINFO_RESPONSE_CODE, &t->status);
+    return http_transfer_response(t);
+}
+
+static VALUE http_request_ensure(VALUE arg) {
+    http_request_args_t *req = (http_request_args_t *)arg;
+    if (req->t.curl) {
+        curl_easy_cleanup(req->t.curl);
+    }
+    http_transfer_free(&req->t);
+    return Qnil;
+}
+
 /*
  * Perform HTTP request with custom method and headers
  *
@@ -314,106 +659,596 @@ VALUE konpeito_http_post_response(VALUE self, VALUE url, VALUE body, VALUE conte
  * @param headers [Hash, nil] Custom headers (optional)
  * @return [Hash] Response with :status, :body, :headers
  * @raise [RuntimeError] if request fails
+ * @raise [ArgumentError] if a header name or value contains CR or LF
  */
 VALUE konpeito_http_request(VALUE self, VALUE method, VALUE url, VALUE body, VALUE headers) {
-    Check_Type(method, T_STRING);
-    Check_Type(url, T_STRING);
+    http_request_args_t req;
+    memset(&req, 0, sizeof(req));
+    req.method = method;
+    req.url = url;
+    req.body = body;
+    req.headers = headers;
+    return rb_ensure(http_request_body, (VALUE)&req, http_request_ensure, (VALUE)&req);
+}
 
-    const char *method_str = RSTRING_PTR(method);
-    const char *url_str = RSTRING_PTR(url);
+/*
+ * KonpeitoHTTP::Client - persistent connections
+ *
+ * A Client keeps its connections open between requests. Transfers run on a
+ * curl multi handle, which owns the connection cache and enforces the
+ * per-host and total connection limits; a CURLSH shares the DNS and TLS
+ * session caches; finished easy handles are reset and reused. Repeated
+ * calls to the same host therefore skip DNS, TCP and TLS handshakes.
+ *
+ * The multi event loop runs without the GVL, so other Ruby threads keep
+ * running during the network wait, and request_all drives many transfers
+ * concurrently from one thread.
+ */
 
-    CURL *curl = curl_easy_init();
-    if (!curl) {
+#define HTTP_CLIENT_MAX_PER_HOST 8
+#define HTTP_CLIENT_MAX_CONNECTIONS 64
+#define HTTP_REQUEST_ALL_CONCURRENCY 16
+
+static const http_options_t http_client_default_options = { 30L, 10L, 1, 1 };
+
+static VALUE cClient;
+
+typedef struct {
+    CURLM *multi;
+    CURLSH *share;
+    CURL **idle;        /* reset easy handles ready for reuse */
+    long idle_count;
+    long idle_capa;
+    http_options_t options;
+    int busy;           /* a thread is running the multi loop */
+} http_client_t;
+
+static void http_client_release(http_client_t *c) {
+    for (long i = 0; i < c->idle_count; i++) {
+        curl_easy_cleanup(c->idle[i]);
+    }
+    c->idle_count = 0;
+    if (c->multi) {
+        curl_multi_cleanup(c->multi);
+        c->multi = NULL;
+    }
+    if (c->share) {
+        curl_share_cleanup(c->share);
+        c->share = NULL;
+    }
+    if (c->idle) {
+        ruby_xfree(c->idle);
+        c->idle = NULL;
+    }
+}
+
+static void http_client_free(void *ptr) {
+    http_client_release((http_client_t *)ptr);
+    ruby_xfree(ptr);
+}
+
+static size_t http_client_memsize(const void *ptr) {
+    const http_client_t *c = (const http_client_t *)ptr;
+    return sizeof(*c) + (size_t)c->idle_capa * sizeof(CURL *);
+}
+
+static const rb_data_type_t http_client_type = {
+    "KonpeitoHTTP::Client",
+    { NULL, http_client_free, http_client_memsize, },
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE http_client_alloc(VALUE klass) {
+    http_client_t *c;
+    return TypedData_Make_Struct(klass, http_client_t, &http_client_type, c);
+}
+
+static http_client_t *http_client_get(VALUE self) {
+    http_client_t *c;
+    TypedData_Get_Struct(self, http_client_t, &http_client_type, c);
+    if (!c->multi) {
+        rb_raise(rb_eIOError, "closed KonpeitoHTTP::Client");
+    }
+    return c;
+}
+
+static void http_client_setup(http_client_t *c, long max_per_host, long max_connections,
+                              const http_options_t *options) {
+    if (max_per_host < 1 || max_connections < 1) {
+        rb_raise(rb_eArgError, "connection limits must be positive");
+    }
+    if (c->busy) {
+        rb_raise(rb_eRuntimeError, "KonpeitoHTTP::Client is in use by another thread");
+    }
+    http_client_release(c);
+
+    c->multi = curl_multi_init();
+    c->share = curl_share_init();
+    if (!c->multi || !c->share) {
+        http_client_release(c);
         rb_raise(rb_eRuntimeError, "Failed to initialize curl");
-        return Qnil;
     }
+    curl_multi_setopt(c->multi, CURLMOPT_MAX_HOST_CONNECTIONS, max_per_host);
+    curl_multi_setopt(c->multi, CURLMOPT_MAXCONNECTS, max_connections);
+    curl_share_setopt(c->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(c->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_multi_setopt(c->multi, CURLMOPT_PIPELINING,
+                      options->http2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+
+    c->idle_capa = max_connections;
+    c->idle = ruby_xcalloc(max_connections, sizeof(CURL *));
+    c->options = *options;
+}
+
+/* Take an idle easy handle, or create one (NULL on failure; no GVL needed) */
+static CURL *http_client_checkout(http_client_t *c) {
+    CURL *curl = c->idle_count > 0 ? c->idle[--c->idle_count] : curl_easy_init();
+    if (curl) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, c->share);
+    }
+    return curl;
+}
 
-    /* Set HTTP method */
-    if (strcmp(method_str, "GET") == 0) {
-        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
-    } else if (strcmp(method_str, "POST") == 0) {
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    } else if (strcmp(method_str, "PUT") == 0) {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-    } else if (strcmp(method_str, "DELETE") == 0) {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    } else if (strcmp(method_str, "PATCH") == 0) {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PATCH");
-    } else if (strcmp(method_str, "HEAD") == 0) {
-        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+/* Reset a finished easy handle and keep it for the next request */
+static void http_client_checkin(http_client_t *c, CURL *curl) {
+    curl_easy_reset(curl);
+    if (c->idle_count < c->idle_capa) {
+        c->idle[c->idle_count++] = curl;
     } else {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method_str);
+        curl_easy_cleanup(curl);
     }
+}
 
-    /* Set request body */
-    if (!NIL_P(body)) {
-        Check_Type(body, T_STRING);
-        const char *body_str = RSTRING_PTR(body);
-        size_t body_len = RSTRING_LEN(body);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body_str);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)body_len);
+/* A batch of transfers driven by one multi loop */
+typedef struct {
+    http_client_t *client;
+    http_transfer_t *transfers;
+    long count;
+    long next;                  /* next transfer to start */
+    long active;
+    long concurrency;
+    volatile int interrupted;
+    CURLMcode error;
+    VALUE requests;             /* request_all: Array of requests */
+    const VALUE *args;          /* request: method, url, body, headers */
+    http_sink_t sink;           /* request: where the body goes */
+    VALUE path;                 /* HTTP_SINK_FILE */
+    VALUE block;                /* HTTP_SINK_BLOCK */
+} http_multi_run_t;
+
+/* Start transfers until the concurrency limit is reached */
+static void http_multi_fill(http_multi_run_t *run) {
+    http_client_t *c = run->client;
+    while (run->active < run->concurrency && run->next < run->count) {
+        http_transfer_t *t = &run->transfers[run->next++];
+        t->curl = http_client_checkout(c);
+        if (!t->curl) {
+            t->result = CURLE_FAILED_INIT;
+            continue;
+        }
+        http_transfer_apply(t, &c->options);
+        if (curl_multi_add_handle(c->multi, t->curl) != CURLM_OK) {
+            t->result = CURLE_FAILED_INIT;
+            http_client_checkin(c, t->curl);
+            t->curl = NULL;
+            continue;
+        }
+        t->active = 1;
+        run->active++;
     }
+}
 
-    /* Set custom headers */
-    struct curl_slist *headers_list = NULL;
-    if (!NIL_P(headers)) {
-        Check_Type(headers, T_HASH);
-        VALUE keys = rb_funcall(headers, rb_intern("keys"), 0);
-        long len = RARRAY_LEN(keys);
-        for (long i = 0; i < len; i++) {
-            VALUE key = rb_ary_entry(keys, i);
-            VALUE val = rb_hash_aref(headers, key);
-            VALUE key_str = RB_TYPE_P(key, T_STRING) ? key : rb_funcall(key, rb_intern("to_s"), 0);
-            VALUE val_str = RB_TYPE_P(val, T_STRING) ? val : rb_funcall(val, rb_intern("to_s"), 0);
-
-            char header_buf[1024];
-            snprintf(header_buf, sizeof(header_buf), "%s: %s",
-                     RSTRING_PTR(key_str), RSTRING_PTR(val_str));
-            headers_list = curl_slist_append(headers_list, header_buf);
+static void http_multi_finish(http_multi_run_t *run, http_transfer_t *t, CURLcode result) {
+    t->result = result;
+    curl_easy_getinfo(t->curl, CURLINFO_RESPONSE_CODE, &t->status);
+    curl_multi_remove_handle(run->client->multi, t->curl);
+    http_client_checkin(run->client, t->curl);
+    t->curl = NULL;
+    t->active = 0;
+    run->active--;
+}
+
+/* Event loop, called without the GVL */
+static void *http_multi_loop(void *arg) {
+    http_multi_run_t *run = (http_multi_run_t *)arg;
+    CURLM *multi = run->client->multi;
+
+    http_multi_fill(run);
+    while (run->active > 0 && !run->interrupted) {
+        int running;
+        CURLMcode mc = curl_multi_perform(multi, &running);
+        if (mc == CURLM_OK) {
+            CURLMsg *msg;
+            int left;
+            while ((msg = curl_multi_info_read(multi, &left))) {
+                if (msg->msg != CURLMSG_DONE) continue;
+                CURLcode result = msg->data.result;
+                http_transfer_t *t;
+                curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&t);
+                http_multi_finish(run, t, result);
+            }
+            http_multi_fill(run);
+            if (run->active > 0) {
+                mc = curl_multi_poll(multi, NULL, 0, 1000, NULL);
+            }
+        }
+        if (mc != CURLM_OK) {
+            run->error = mc;
+            break;
         }
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_list);
     }
+    return NULL;
+}
 
-    response_buffer_t buf = {0};
-    buf.data = malloc(1);
-    buf.data[0] = '\0';
-    buf.size = 0;
+/* Interrupt (Thread#raise, Ctrl-C): leave the loop so Ruby can handle it */
+static void http_multi_ubf(void *arg) {
+    http_multi_run_t *run = (http_multi_run_t *)arg;
+    run->interrupted = 1;
+    curl_multi_wakeup(run->client->multi);
+}
 
-    VALUE response_headers = rb_hash_new();
+static void http_multi_run(http_multi_run_t *run) {
+    while (run->active > 0 || run->next < run->count) {
+        run->interrupted = 0;
+        rb_thread_call_without_gvl(http_multi_loop, run, http_multi_ubf, run);
+        if (run->error != CURLM_OK) {
+            rb_raise(rb_eRuntimeError, "HTTP request failed: %s", curl_multi_strerror(run->error));
+        }
+        rb_thread_check_ints();
+    }
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, url_str);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buf);
-    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
-    curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)response_headers);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Konpeito-HTTP/1.0");
+/* Request spec of request_all: a URL String (GET) or a Hash with :url, :method, :body, :headers */
+static void http_transfer_prepare_spec(http_transfer_t *t, VALUE spec) {
+    if (RB_TYPE_P(spec, T_STRING)) {
+        http_transfer_prepare(t, rb_str_new_cstr("GET"), spec, Qnil, Qnil);
+        return;
+    }
+    Check_Type(spec, T_HASH);
+    VALUE method = rb_hash_aref(spec, ID2SYM(rb_intern("method")));
+    if (NIL_P(method)) {
+        method = rb_str_new_cstr("GET");
+    } else if (SYMBOL_P(method)) {
+        method = rb_funcall(rb_sym2str(method), rb_intern("upcase"), 0);
+    }
+    http_transfer_prepare(t, method,
+                          rb_hash_aref(spec, ID2SYM(rb_intern("url"))),
+                          rb_hash_aref(spec, ID2SYM(rb_intern("body"))),
+                          rb_hash_aref(spec, ID2SYM(rb_intern("headers"))));
+}
 
-    CURLcode res = curl_easy_perform(curl);
+static VALUE http_client_request_body(VALUE arg) {
+    http_multi_run_t *run = (http_multi_run_t *)arg;
+    http_transfer_t *t = &run->transfers[0];
+    http_transfer_prepare(t, run->args[0], run->args[1], run->args[2], run->args[3]);
 
-    if (headers_list) {
-        curl_slist_free_all(headers_list);
+    t->sink = run->sink;
+    if (t->sink == HTTP_SINK_FILE) {
+        t->file = fopen(StringValueCStr(run->path), "wb");
+        if (!t->file) {
+            rb_sys_fail_str(run->path);
+        }
+    } else if (t->sink == HTTP_SINK_BLOCK) {
+        t->block = run->block;
     }
 
-    if (res != CURLE_OK) {
-        free(buf.data);
-        curl_easy_cleanup(curl);
-        rb_raise(rb_eRuntimeError, "HTTP request failed: %s", curl_easy_strerror(res));
-        return Qnil;
+    http_multi_run(run);
+    if (t->exc_state) {
+        rb_jump_tag(t->exc_state);
+    }
+    if (t->result != CURLE_OK) {
+        rb_raise(rb_eRuntimeError, "HTTP request failed: %s", curl_easy_strerror(t->result));
     }
 
-    long status_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
+    if (t->sink == HTTP_SINK_FILE) {
+        int failed = fclose(t->file) != 0;
+        t->file = NULL;
+        if (failed) {
+            rb_sys_fail_str(run->path);
+        }
+    } else if (t->sink == HTTP_SINK_BLOCK && t->response.size > 0) {
+        http_stream_yield_chunk((VALUE)t);
+    }
+    return http_transfer_response(t);
+}
 
-    VALUE result = rb_hash_new();
-    rb_hash_aset(result, ID2SYM(rb_intern("status")), LONG2NUM(status_code));
-    rb_hash_aset(result, ID2SYM(rb_intern("body")), rb_utf8_str_new(buf.data, buf.size));
-    rb_hash_aset(result, ID2SYM(rb_intern("headers")), response_headers);
+static VALUE http_client_request_all_body(VALUE arg) {
+    http_multi_run_t *run = (http_multi_run_t *)arg;
+    for (long i = 0; i < run->count; i++) {
+        http_transfer_prepare_spec(&run->transfers[i], rb_ary_entry(run->requests, i));
+    }
+    http_multi_run(run);
+
+    VALUE result = rb_ary_new_capa(run->count);
+    for (long i = 0; i < run->count; i++) {
+        http_transfer_t *t = &run->transfers[i];
+        if (t->result == CURLE_OK) {
+            rb_ary_push(result, http_transfer_response(t));
+        } else {
+            VALUE failed = rb_hash_new();
+            rb_hash_aset(failed, ID2SYM(rb_intern("status")), INT2FIX(0));
+            rb_hash_aset(failed, ID2SYM(rb_intern("body")), Qnil);
+            rb_hash_aset(failed, ID2SYM(rb_intern("headers")), rb_hash_new());
+            rb_hash_aset(failed, ID2SYM(rb_intern("error")), rb_str_new_cstr(curl_easy_strerror(t->result)));
+            rb_ary_push(result, failed);
+        }
+    }
+    return result;
+}
 
-    free(buf.data);
-    curl_easy_cleanup(curl);
+/* Abort transfers still running (after an exception) and free the batch */
+static VALUE http_multi_run_ensure(VALUE arg) {
+    http_multi_run_t *run = (http_multi_run_t *)arg;
+    http_client_t *c = run->client;
+    for (long i = 0; i < run->count; i++) {
+        http_transfer_t *t = &run->transfers[i];
+        if (t->curl) {
+            if (t->active) {
+                curl_multi_remove_handle(c->multi, t->curl);
+            }
+            http_client_checkin(c, t->curl);
+        }
+        http_transfer_free(t);
+    }
+    ruby_xfree(run->transfers);
+    c->busy = 0;
+    return Qnil;
+}
 
+/* Run count transfers on the client; body prepares them, runs the loop and builds the result */
+static VALUE http_client_run(VALUE self, http_multi_run_t *run, long count, VALUE (*body)(VALUE)) {
+    http_client_t *c = http_client_get(self);
+    if (c->busy) {
+        rb_raise(rb_eRuntimeError, "KonpeitoHTTP::Client is in use by another thread");
+    }
+    run->client = c;
+    run->count = count;
+    run->transfers = ruby_xcalloc(count > 0 ? count : 1, sizeof(http_transfer_t));
+    c->busy = 1;
+    VALUE result = rb_ensure(body, (VALUE)run, http_multi_run_ensure, (VALUE)run);
+    RB_GC_GUARD(self);
+    return result;
+}
+
+/*
+ * Create a client with persistent connections
+ *
+ * @param max_per_host [Integer] connections per host (keyword, default: 8)
+ * @param max_connections [Integer] connections kept open in total (keyword, default: 64)
+ * @param timeout [Integer] request timeout in seconds (keyword, default: 30)
+ * @param connect_timeout [Integer] connect timeout in seconds (keyword, default: 10)
+ * @param compressed [Boolean] send Accept-Encoding and decode gzip/deflate/br/zstd
+ *   bodies (keyword, default: true)
+ * @param http2 [Boolean] negotiate HTTP/2 over TLS and multiplex requests to a
+ *   host on one connection (keyword, default: true)
+ */
+static VALUE http_client_initialize(int argc, VALUE *argv, VALUE self) {
+    VALUE opts;
+    rb_scan_args(argc, argv, "0:", &opts);
+
+    long max_per_host = HTTP_CLIENT_MAX_PER_HOST;
+    long max_connections = HTTP_CLIENT_MAX_CONNECTIONS;
+    http_options_t options = http_client_default_options;
+    if (!NIL_P(opts)) {
+        ID kw[6] = {
+            rb_intern("max_per_host"), rb_intern("max_connections"),
+            rb_intern("timeout"), rb_intern("connect_timeout"),
+            rb_intern("compressed"), rb_intern("http2")
+        };
+        VALUE vals[6];
+        rb_get_kwargs(opts, kw, 0, 6, vals);
+        if (vals[0] != Qundef) max_per_host = NUM2LONG(vals[0]);
+        if (vals[1] != Qundef) max_connections = NUM2LONG(vals[1]);
+        if (vals[2] != Qundef) options.timeout = NUM2LONG(vals[2]);
+        if (vals[3] != Qundef) options.connect_timeout = NUM2LONG(vals[3]);
+        if (vals[4] != Qundef) options.compressed = RTEST(vals[4]);
+        if (vals[5] != Qundef) options.http2 = RTEST(vals[5]);
+    }
+
+    http_client_t *c;
+    TypedData_Get_Struct(self, http_client_t, &http_client_type, c);
+    http_client_setup(c, max_per_host, max_connections, &options);
+    return self;
+}
+
+/*
+ * Perform HTTP request on a pooled connection
+ *
+ * @param method [String] HTTP method (GET, POST, PUT, DELETE, PATCH, HEAD)
+ * @param url [String] URL
+ * @param body [String, nil] Request body (optional)
+ * @param headers [Hash, nil] Custom headers (optional)
+ * @return [Hash] Response with :status, :body, :headers
+ * @raise [RuntimeError] if request fails
+ * @raise [IOError] if the client is closed
+ */
+static VALUE http_client_request(int argc, VALUE *argv, VALUE self) {
+    VALUE args[4];
+    rb_scan_args(argc, argv, "22", &args[0], &args[1], &args[2], &args[3]);
+
+    http_multi_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.args = args;
+    run.concurrency = 1;
+    return http_client_run(self, &run, 1, http_client_request_body);
+}
+
+/*
+ * Perform HTTP GET request on a pooled connection
+ *
+ * @param url [String] URL to fetch
+ * @param headers [Hash, nil] Custom headers (optional)
+ * @return [Hash] Response with :status, :body, :headers
+ */
+static VALUE http_client_get_request(int argc, VALUE *argv, VALUE self) {
+    VALUE url, headers;
+    rb_scan_args(argc, argv, "11", &url, &headers);
+    VALUE args[4] = { rb_str_new_cstr("GET"), url, Qnil, headers };
+    return http_client_request(4, args, self);
+}
+
+/*
+ * Perform HTTP POST request on a pooled connection
+ *
+ * @param url [String] URL to post to
+ * @param body [String] Request body
+ * @param headers [Hash, nil] Custom headers (optional)
+ * @return [Hash] Response with :status, :body, :headers
+ */
+static VALUE http_client_post_request(int argc, VALUE *argv, VALUE self) {
+    VALUE url, body, headers;
+    rb_scan_args(argc, argv, "21", &url, &body, &headers);
+    Check_Type(body, T_STRING);
+    VALUE args[4] = { rb_str_new_cstr("POST"), url, body, headers };
+    return http_client_request(4, args, self);
+}
+
+/*
+ * Perform HTTP request, yielding the body in chunks instead of buffering it
+ *
+ * Chunks (binary Strings of up to about 64KB) are yielded as they arrive,
+ * so memory use stays flat for any body size. If the block raises, the
+ * transfer is aborted and the exception propagates.
+ *
+ * @param method [String] HTTP method
+ * @param url [String] URL
+ * @param body [String, nil] Request body (optional)
+ * @param headers [Hash, nil] Custom headers (optional)
+ * @yield [chunk] each part of the response body
+ * @return [Hash] Response with :status, :headers, :size (body is nil)
+ */
+static VALUE http_client_stream(int argc, VALUE *argv, VALUE self) {
+    VALUE args[4];
+    rb_scan_args(argc, argv, "22", &args[0], &args[1], &args[2], &args[3]);
+    rb_need_block();
+
+    http_multi_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.args = args;
+    run.concurrency = 1;
+    run.sink = HTTP_SINK_BLOCK;
+    run.block = rb_block_proc();
+    VALUE result = http_client_run(self, &run, 1, http_client_request_body);
+    RB_GC_GUARD(run.block);
+    return result;
+}
+
+/*
+ * Download a URL straight to a file
+ *
+ * The body is written as it arrives (never held in memory). The file is
+ * written for any status; check :status.
+ *
+ * @param url [String] URL to fetch
+ * @param path [String] destination file (created/truncated)
+ * @param headers [Hash, nil] Custom headers (optional)
+ * @return [Hash] Response with :status, :headers, :size (body is nil)
+ */
+static VALUE http_client_download(int argc, VALUE *argv, VALUE self) {
+    VALUE url, path, headers;
+    rb_scan_args(argc, argv, "21", &url, &path, &headers);
+    FilePathValue(path);
+
+    VALUE args[4] = { rb_str_new_cstr("GET"), url, Qnil, headers };
+    http_multi_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.args = args;
+    run.concurrency = 1;
+    run.sink = HTTP_SINK_FILE;
+    run.path = path;
+    return http_client_run(self, &run, 1, http_client_request_body);
+}
+
+static long http_concurrency_opt(VALUE opts) {
+    long concurrency = HTTP_REQUEST_ALL_CONCURRENCY;
+    if (!NIL_P(opts)) {
+        ID kw = rb_intern("concurrency");
+        VALUE val;
+        rb_get_kwargs(opts, &kw, 0, 1, &val);
+        if (val != Qundef) concurrency = NUM2LONG(val);
+    }
+    if (concurrency < 1) {
+        rb_raise(rb_eArgError, "concurrency must be positive");
+    }
+    return concurrency;
+}
+
+/*
+ * Perform many requests concurrently on pooled connections
+ *
+ * Up to concurrency transfers run at once (still subject to max_per_host)
+ * in one event loop without the GVL. A failed transfer does not stop the
+ * others; its entry has :status 0 and an :error message.
+ *
+ * @param requests [Array<String, Hash>] URLs (GET), or Hashes with :url and
+ *   optional :method, :body, :headers
+ * @param concurrency [Integer] transfers in flight (keyword, default: 16)
+ * @return [Array<Hash>] responses with :status, :body, :headers, in input order
+ */
+static VALUE http_client_request_all(int argc, VALUE *argv, VALUE self) {
+    VALUE requests, opts;
+    rb_scan_args(argc, argv, "1:", &requests, &opts);
+    Check_Type(requests, T_ARRAY);
+
+    http_multi_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.requests = requests;
+    run.concurrency = http_concurrency_opt(opts);
+    VALUE result = http_client_run(self, &run, RARRAY_LEN(requests), http_client_request_all_body);
+    RB_GC_GUARD(requests);
+    return result;
+}
+
+/* Close all connections and release the handles; the client cannot be used afterwards */
+static VALUE http_client_close(VALUE self) {
+    http_client_t *c;
+    TypedData_Get_Struct(self, http_client_t, &http_client_type, c);
+    if (c->busy) {
+        rb_raise(rb_eRuntimeError, "KonpeitoHTTP::Client is in use by another thread");
+    }
+    http_client_release(c);
+    return Qnil;
+}
+
+static VALUE http_client_closed_p(VALUE self) {
+    http_client_t *c;
+    TypedData_Get_Struct(self, http_client_t, &http_client_type, c);
+    return c->multi ? Qfalse : Qtrue;
+}
+
+/*
+ * Perform many requests concurrently (see Client#request_all)
+ *
+ * Uses a temporary client allowing concurrency connections per host. Like
+ * the other module functions it sends no Accept-Encoding and stays on
+ * HTTP/1.1; only the Client's connect timeout is added.
+ *
+ * @param requests [Array<String, Hash>] URLs (GET), or Hashes with :url and
+ *   optional :method, :body, :headers
+ * @param concurrency [Integer] transfers in flight (keyword, default: 16)
+ * @return [Array<Hash>] responses with :status, :body, :headers, in input order
+ */
+VALUE konpeito_http_request_all(int argc, VALUE *argv, VALUE self) {
+    VALUE requests, opts;
+    rb_scan_args(argc, argv, "1:", &requests, &opts);
+    long concurrency = http_concurrency_opt(opts);
+
+    Check_Type(requests, T_ARRAY);
+
+    VALUE client = http_client_alloc(cClient);
+    http_client_t *c;
+    TypedData_Get_Struct(client, http_client_t, &http_client_type, c);
+    http_options_t options = http_default_options;
+    options.connect_timeout = http_client_default_options.connect_timeout;
+    http_client_setup(c, concurrency, concurrency, &options);
+
+    http_multi_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.requests = requests;
+    run.concurrency = concurrency;
+    VALUE result = http_client_run(client, &run, RARRAY_LEN(requests), http_client_request_all_body);
+    http_client_release(c);
+    RB_GC_GUARD(requests);
     return result;
 }
 
@@ -435,6 +1270,22 @@ void Init_konpeito_http(void) {
     /* Generic request method */
     rb_define_module_function(mKonpeitoHTTP, "request", konpeito_http_request, 4);
 
+    /* Concurrent requests (curl multi, GVL released) */
+    rb_define_module_function(mKonpeitoHTTP, "request_all", konpeito_http_request_all, -1);
+
+    /* Client with persistent connections */
+    cClient = rb_define_class_under(mKonpeitoHTTP, "Client", rb_cObject);
+    rb_define_alloc_func(cClient, http_client_alloc);
+    rb_define_method(cClient, "initialize", http_client_initialize, -1);
+    rb_define_method(cClient, "request", http_client_request, -1);
+    rb_define_method(cClient, "get", http_client_get_request, -1);
+    rb_define_method(cClient, "post", http_client_post_request, -1);
+    rb_define_method(cClient, "request_all", http_client_request_all, -1);
+    rb_define_method(cClient, "stream", http_client_stream, -1);
+    rb_define_method(cClient, "download", http_client_download, -1);
+    rb_define_method(cClient, "close", http_client_close, 0);
+    rb_define_method(cClient, "closed?", http_client_closed_p, 0);
+
     /* Register cleanup at exit */
     rb_set_end_proc((void (*)(VALUE))curl_global_cleanup, Qnil);
 }
@@ -11,6 +11,9 @@ $INCFLAGS << " -I#{yyjson_dir}"
 $srcs = ['json_native.c', File.join(yyjson_dir, 'yyjson.c')]
 $VPATH << yyjson_dir
 
+# parse_many reads documents on a pthread pool
+have_library('pthread')
+
 # Optimization flags
 $CFLAGS << ' -O3'
 
@@ -10,12 +10,41 @@
 #   obj = KonpeitoJSON.parse('{"name": "Alice", "age": 30}')
 #   # => {"name" => "Alice", "age" => 30}
 #
+#   # Symbol keys
+#   obj = KonpeitoJSON.parse('{"name": "Alice"}', symbolize_names: true)
+#   # => {name: "Alice"}
+#
+#   # Parse in place (the String is consumed and left empty)
+#   obj = KonpeitoJSON.parse(body, insitu: true)
+#
+#   # Read flags; BIGNUM_AS_RAW keeps huge integers exact
+#   obj = KonpeitoJSON.parse(text, KonpeitoJSON::ALLOW_COMMENTS | KonpeitoJSON::BIGNUM_AS_RAW)
+#
+#   # Many documents at once (read in parallel without the GVL)
+#   objs = KonpeitoJSON.parse_many(bodies, threads: 4)
+#
 #   # Generate JSON
 #   json = KonpeitoJSON.generate({name: "Bob", active: true})
 #   # => '{"name":"Bob","active":true}'
 #
 #   # Pretty print
 #   json = KonpeitoJSON.generate_pretty({a: 1, b: 2}, 2)
+#
+#   # Object fields (specialized per class for NativeClass in compiled code)
+#   json = KonpeitoJSON.generate_as(point)   # => '{"x":1,"y":2}'
+#
+#   # On-demand access (only the touched values are converted)
+#   doc = KonpeitoJSON.open(large_json)
+#   id = doc.at("/data/0/id")
+#   user = doc["data"][0]    # => KonpeitoJSON::View
+#   user["name"]             # => "Alice"
+#
+#   # NDJSON / JSON Lines (streamed in chunks, constant memory)
+#   KonpeitoJSON.each_ndjson("events.ndjson") { |event| ... }
+#   KonpeitoJSON.write_ndjson("out.ndjson", records)
+#   writer = KonpeitoJSON::NDJSONWriter.new(io)
+#   writer << record
+#   writer.close
 
 # Try to load the native extension
 begin
@@ -28,10 +57,35 @@ rescue LoadError
     ALLOW_COMMENTS = 1 << 3
     ALLOW_TRAILING_COMMAS = 1 << 2
     ALLOW_INF_NAN = 1 << 4
+    NUMBER_AS_RAW = 1 << 5
+    BIGNUM_AS_RAW = 1 << 7
+
+    class ParseError < ArgumentError
+      attr_reader :position
+    end
+
+    # The JSON gem already reads integers exactly, so the raw-number flags need no handling
+    def self.parse(json_string, flags = 0, symbolize_names: false, insitu: false)
+      result = gem_parse(json_string, flags, symbolize_names)
+      json_string.clear if insitu
+      result
+    end
+
+    def self.parse_many(json_strings, flags = 0, symbolize_names: false, threads: nil)
+      json_strings.each_with_index.map do |json_string, i|
+        gem_parse(json_string, flags, symbolize_names)
+      rescue ParseError => e
+        raise ParseError, e.message.sub("JSON parse error", "JSON parse error in document #{i}")
+      end
+    end
 
-    def self.parse(json_string)
-      JSON.parse(json_string)
+    def self.gem_parse(json_string, flags, symbolize_names)
+      JSON.parse(json_string, symbolize_names: symbolize_names,
+                              allow_nan: (flags.to_i & ALLOW_INF_NAN) != 0)
+    rescue JSON::ParserError => e
+      raise ParseError, "JSON parse error: #{e.message}"
     end
+    private_class_method :gem_parse
 
     def self.generate(obj)
       JSON.generate(obj)
@@ -40,5 +94,128 @@ rescue LoadError
     def self.generate_pretty(obj, indent = 2)
       JSON.pretty_generate(obj)
     end
+
+    def self.generate_as(obj)
+      JSON.generate(fields_of(obj))
+    end
+
+    def self.generate_array_as(objects)
+      JSON.generate(objects.map { |obj| fields_of(obj) })
+    end
+
+    def self.fields_of(obj)
+      obj.instance_variables.to_h { |ivar| [ivar.to_s.delete_prefix("@"), obj.instance_variable_get(ivar)] }
+    end
+    private_class_method :fields_of
+
+    def self.open(json_string, flags = 0, symbolize_names: false)
+      Document.new(gem_parse(json_string, flags, symbolize_names))
+    end
+
+    def self.each_ndjson(source, symbolize_names: false, raw: false)
+      return enum_for(:each_ndjson, source, symbolize_names: symbolize_names, raw: raw) unless block_given?
+
+      io = source.is_a?(String) ? File.open(source, "rb") : source
+      io.each_line do |line|
+        line = line.chomp
+        next if line.strip.empty?
+
+        yield raw ? line : gem_parse(line, 0, symbolize_names)
+      end
+      nil
+    ensure
+      io.close if source.is_a?(String) && io
+    end
+
+    def self.write_ndjson(dest, objects)
+      writer = NDJSONWriter.new(dest)
+      objects.each { |obj| writer << obj }
+      objects.size
+    ensure
+      writer&.close
+    end
+
+    class NDJSONWriter
+      def initialize(dest)
+        @owns_io = dest.is_a?(String)
+        @io = @owns_io ? File.open(dest, "wb") : dest
+      end
+
+      def write(obj)
+        raise IOError, "closed NDJSONWriter" if @closed
+
+        @io.write(JSON.generate(obj), "\n")
+        self
+      end
+      alias << write
+
+      def flush
+        @io.flush if @io.respond_to?(:flush)
+        self
+      end
+
+      def close
+        return if @closed
+
+        flush
+        @closed = true
+        @io.close if @owns_io
+        nil
+      end
+    end
+
+    # Fallback documents/views wrap already-parsed Ruby objects
+    module Lookup
+      def at(pointer)
+        return @value if pointer.empty?
+        return nil unless pointer.start_with?("/")
+
+        pointer[1..].split("/", -1).reduce(@value) do |node, token|
+          token = token.gsub("~1", "/").gsub("~0", "~")
+          case node
+          when Hash then node.fetch(token) { node.fetch(token.to_sym) { return nil } }
+          when Array then token.match?(/\A(0|[1-9]\d*)\z/) ? node.fetch(token.to_i) { return nil } : (return nil)
+          else return nil
+          end
+        end
+      end
+
+      def [](key)
+        node = case @value
+               when Hash then @value.fetch(key) { @value[key.is_a?(Symbol) ? key.to_s : key.to_sym] }
+               when Array then @value[key]
+               end
+        node.is_a?(Hash) || node.is_a?(Array) ? View.new(node) : node
+      end
+
+      def to_ruby
+        @value
+      end
+    end
+
+    class Document
+      include Lookup
+
+      def initialize(value)
+        @value = value
+      end
+
+      def root
+        @value.is_a?(Hash) || @value.is_a?(Array) ? View.new(@value) : @value
+      end
+    end
+
+    class View
+      include Lookup
+
+      def initialize(value)
+        @value = value
+      end
+
+      def size = @value.size
+      def keys = @value.is_a?(Hash) ? @value.keys : []
+      def object? = @value.is_a?(Hash)
+      def array? = @value.is_a?(Array)
+    end
   end
 end
@@ -0,0 +1,60 @@
+/*
+ * json_encoder.c - Runtime support for KonpeitoJSON.generate_as
+ *
+ * The LLVM backend specializes generate_as / generate_array_as per
+ * NativeClass: every key (with its surrounding punctuation) becomes a
+ * precomputed fragment appended with rb_str_cat, and only field values
+ * go through the helpers below. This file is linked into compiled code
+ * together with yyjson; it is not part of the konpeito_json extension.
+ */
+
+#include "json_writer.h"
+#include <stdint.h>
+
+/* Writer over buf, picking up at its current length */
+static inline json_writer_t json_enc_writer(VALUE buf) {
+    json_writer_t w;
+    w.buf = buf;
+    w.len = (size_t)RSTRING_LEN(buf);
+    w.pretty = 0;
+    w.depth = 0;
+    return w;
+}
+
+static inline void json_enc_done(json_writer_t *w) {
+    rb_str_set_len(w->buf, (long)w->len);
+}
+
+/* Output buffer: an empty UTF-8 String with room for capa bytes */
+VALUE konpeito_json_enc_new(long capa) {
+    VALUE buf = rb_str_buf_new(capa > JSON_WRITER_INITIAL_CAPA ? capa : JSON_WRITER_INITIAL_CAPA);
+    rb_enc_associate_index(buf, rb_utf8_encindex());
+    return buf;
+}
+
+/* Int64 field */
+void konpeito_json_enc_int(VALUE buf, int64_t num) {
+    json_writer_t w = json_enc_writer(buf);
+    json_writer_long(&w, (long)num);
+    json_enc_done(&w);
+}
+
+/* Float64 field; raises RuntimeError for NaN/Infinity */
+void konpeito_json_enc_real(VALUE buf, double num) {
+    json_writer_t w = json_enc_writer(buf);
+    json_writer_double(&w, num);
+    json_enc_done(&w);
+}
+
+/*
+ * VALUE field (String, Array, Hash, Object), written with the same
+ * streaming writer as KonpeitoJSON.generate. The konpeito_json extension
+ * does not have to be loaded.
+ */
+void konpeito_json_enc_value(VALUE buf, VALUE obj) {
+    if (!json_writer_id_to_s) json_writer_init_ids();
+
+    json_writer_t w = json_enc_writer(buf);
+    json_writer_value(&w, obj);
+    json_enc_done(&w);
+}
@@ -1,18 +1,100 @@
 /*
  * Konpeito JSON stdlib - yyjson wrapper
  *
- * Provides fast JSON parsing and generation using yyjson library.
+ * Provides fast JSON parsing using the yyjson library, and JSON generation
+ * through a streaming writer that writes straight into the result String.
  */
 
 #include <ruby.h>
+#include <ruby/encoding.h>
+#include <ruby/thread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include "../../../../vendor/yyjson/yyjson.h"
+#include "json_writer.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/* Object key cache: direct-mapped, keys up to KEY_CACHE_MAX_LEN bytes */
+#define KEY_CACHE_SIZE 256
+#define KEY_CACHE_MAX_LEN 32
+
+typedef struct {
+    VALUE str;  /* frozen, deduplicated key String (0 = empty slot) */
+    VALUE key;  /* str itself, or its Symbol when symbolize_names is set */
+} json_key_cache_entry_t;
+
+/*
+ * Per-parse state. Lives on the C stack of the parse call, so the cached
+ * VALUEs are kept alive by the conservative stack scan.
+ */
+typedef struct {
+    int symbolize_names;
+    json_key_cache_entry_t keys[KEY_CACHE_SIZE];
+} json_parse_ctx_t;
+
+static ID id_symbolize_names;
+static ID id_insitu;
+static ID id_threads;
+static ID id_at_position;
+static VALUE eParseError;
 
 /* Forward declarations */
-static VALUE yyjson_val_to_ruby(yyjson_val *val);
-static yyjson_mut_val *ruby_to_yyjson_mut(yyjson_mut_doc *doc, VALUE obj);
+static VALUE yyjson_val_to_ruby(json_parse_ctx_t *ctx, yyjson_val *val);
+
+/* FNV-1a over the key bytes, used to pick a cache slot */
+static inline unsigned int key_cache_slot(const char *str, size_t len) {
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)str[i]) * 16777619u;
+    }
+    return h & (KEY_CACHE_SIZE - 1);
+}
+
+/*
+ * Convert an object key to a Ruby Hash key.
+ * Returns a frozen fstring (or Symbol), so repeated keys across records
+ * share one object and Hash#[]= does not need to dup and freeze them.
+ */
+static VALUE json_object_key(json_parse_ctx_t *ctx, const char *str, size_t len) {
+    if (len > KEY_CACHE_MAX_LEN) {
+        VALUE fstr = rb_enc_interned_str(str, (long)len, rb_utf8_encoding());
+        return ctx->symbolize_names ? rb_str_intern(fstr) : fstr;
+    }
+
+    json_key_cache_entry_t *entry = &ctx->keys[key_cache_slot(str, len)];
+    if (entry->str && (size_t)RSTRING_LEN(entry->str) == len &&
+        memcmp(RSTRING_PTR(entry->str), str, len) == 0) {
+        return entry->key;
+    }
+
+    VALUE fstr = rb_enc_interned_str(str, (long)len, rb_utf8_encoding());
+    entry->str = fstr;
+    entry->key = ctx->symbolize_names ? rb_str_intern(fstr) : fstr;
+    return entry->key;
+}
+
+/*
+ * Convert a raw number (NUMBER_AS_RAW / BIGNUM_AS_RAW) exactly: integers of
+ * any size become Integer, everything else (fractions, exponents, and
+ * Infinity/NaN literals) goes through strtod. yyjson NUL-terminates raws.
+ */
+static VALUE json_raw_number(const char *str, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char c = str[i];
+        if (c != '-' && (c < '0' || c > '9')) {
+            return DBL2NUM(strtod(str, NULL));
+        }
+    }
+    return rb_cstr_to_inum(str, 10, 0);
+}
 
 /* Convert yyjson value to Ruby VALUE (recursive) */
-static VALUE yyjson_val_to_ruby(yyjson_val *val) {
+static VALUE yyjson_val_to_ruby(json_parse_ctx_t *ctx, yyjson_val *val) {
     if (!val) return Qnil;
 
     yyjson_type type = yyjson_get_type(val);
@@ -33,6 +115,9 @@ static VALUE yyjson_val_to_ruby(yyjson_val *val) {
             return DBL2NUM(yyjson_get_real(val));
         }
 
+    case YYJSON_TYPE_RAW:
+        return json_raw_number(yyjson_get_raw(val), yyjson_get_len(val));
+
     case YYJSON_TYPE_STR: {
         const char *str = yyjson_get_str(val);
         size_t len = yyjson_get_len(val);
@@ -45,7 +130,7 @@ static VALUE yyjson_val_to_ruby(yyjson_val *val) {
         yyjson_arr_iter_init(val, &iter);
         yyjson_val *elem;
         while ((elem = yyjson_arr_iter_next(&iter))) {
-            rb_ary_push(arr, yyjson_val_to_ruby(elem));
+            rb_ary_push(arr, yyjson_val_to_ruby(ctx, elem));
         }
         return arr;
     }
@@ -60,8 +145,8 @@ static VALUE yyjson_val_to_ruby(yyjson_val *val) {
             const char *key_str = yyjson_get_str(key);
             size_t key_len = yyjson_get_len(key);
             rb_hash_aset(hash,
-                         rb_utf8_str_new(key_str, key_len),
-                         yyjson_val_to_ruby(obj_val));
+                         json_object_key(ctx, key_str, key_len),
+                         yyjson_val_to_ruby(ctx, obj_val));
         }
         return hash;
     }
@@ -71,167 +156,450 @@ static VALUE yyjson_val_to_ruby(yyjson_val *val) {
     }
 }
 
-/* Convert Ruby VALUE to yyjson mutable value (recursive) */
-static yyjson_mut_val *ruby_to_yyjson_mut(yyjson_mut_doc *doc, VALUE obj) {
-    if (NIL_P(obj)) {
-        return yyjson_mut_null(doc);
-    }
+/* rb_ivar_foreach callback: write one instance variable as a key/value pair */
+static int ivar_pair_write(ID id, VALUE val, st_data_t data) {
+    json_hash_write_arg_t *arg = (json_hash_write_arg_t *)data;
+    json_writer_t *w = arg->w;
 
-    if (obj == Qtrue) {
-        return yyjson_mut_bool(doc, true);
+    /* Skip internal ivars; "@name" is written as "name" */
+    VALUE name = rb_id2str(id);
+    if (!name || RSTRING_LEN(name) < 2 || RSTRING_PTR(name)[0] != '@') {
+        return ST_CONTINUE;
     }
 
-    if (obj == Qfalse) {
-        return yyjson_mut_bool(doc, false);
-    }
+    if (!arg->first) json_writer_byte(w, ',');
+    arg->first = 0;
 
-    if (RB_INTEGER_TYPE_P(obj)) {
-        if (FIXNUM_P(obj)) {
-            return yyjson_mut_sint(doc, FIX2LONG(obj));
-        } else {
-            /* Bignum - try to convert to long long */
-            return yyjson_mut_sint(doc, NUM2LL(obj));
-        }
-    }
+    json_writer_byte(w, '"');
+    json_writer_append(w, RSTRING_PTR(name) + 1, RSTRING_LEN(name) - 1);
+    json_writer_append(w, "\":", 2);
+    json_writer_value(w, val);
+
+    return ST_CONTINUE;
+}
+
+/* Write an object's instance variables as a JSON object (generate_as) */
+static void json_writer_fields(json_writer_t *w, VALUE obj) {
+    json_hash_write_arg_t arg;
+    arg.w = w;
+    arg.first = 1;
 
-    if (RB_FLOAT_TYPE_P(obj)) {
-        return yyjson_mut_real(doc, NUM2DBL(obj));
+    json_writer_byte(w, '{');
+    rb_ivar_foreach(obj, ivar_pair_write, (st_data_t)&arg);
+    json_writer_byte(w, '}');
+}
+
+/* Write an Array of objects as a JSON array of field objects (generate_array_as) */
+static void json_writer_fields_array(json_writer_t *w, VALUE ary) {
+    Check_Type(ary, T_ARRAY);
+
+    json_writer_byte(w, '[');
+    for (long i = 0; i < RARRAY_LEN(ary); i++) {
+        if (i > 0) json_writer_byte(w, ',');
+        json_writer_fields(w, RARRAY_AREF(ary, i));
     }
+    json_writer_byte(w, ']');
+}
+
+/* Serialize obj with write_fn into a new UTF-8 String */
+static VALUE json_write(VALUE obj, int pretty, void (*write_fn)(json_writer_t *, VALUE)) {
+    json_writer_t w;
+    w.buf = rb_str_buf_new(JSON_WRITER_INITIAL_CAPA);
+    rb_enc_associate_index(w.buf, rb_utf8_encindex());
+    w.len = 0;
+    w.pretty = pretty;
+    w.depth = 0;
+
+    write_fn(&w, obj);
+
+    /* Trims the excess capacity left by geometric growth */
+    rb_str_resize(w.buf, (long)w.len);
+    return w.buf;
+}
+
+/* Read the symbolize_names: keyword from an options hash (nil if none) */
+static int json_opt_symbolize_names(VALUE opts) {
+    if (NIL_P(opts)) return 0;
+    VALUE symbolize_names;
+    rb_get_kwargs(opts, &id_symbolize_names, 0, 1, &symbolize_names);
+    return symbolize_names != Qundef && RTEST(symbolize_names);
+}
 
-    if (RB_TYPE_P(obj, T_STRING)) {
-        const char *str = RSTRING_PTR(obj);
-        size_t len = RSTRING_LEN(obj);
-        return yyjson_mut_strncpy(doc, str, len);
+/* Raise KonpeitoJSON::ParseError (an ArgumentError) carrying the byte position */
+NORETURN(static void json_raise_parse_error_msg(const yyjson_read_err *err, VALUE msg));
+static void json_raise_parse_error_msg(const yyjson_read_err *err, VALUE msg) {
+    VALUE exc = rb_exc_new_str(eParseError, msg);
+    rb_ivar_set(exc, id_at_position, SIZET2NUM(err->pos));
+    rb_exc_raise(exc);
+}
+
+NORETURN(static void json_raise_parse_error(const yyjson_read_err *err, long lineno));
+static void json_raise_parse_error(const yyjson_read_err *err, long lineno) {
+    VALUE msg = lineno > 0
+        ? rb_sprintf("JSON parse error at line %ld, position %zu: %s", lineno, err->pos, err->msg)
+        : rb_sprintf("JSON parse error at position %zu: %s", err->pos, err->msg);
+    json_raise_parse_error_msg(err, msg);
+}
+
+/* Read flags from an optional Integer argument (nil = 0) */
+static yyjson_read_flag json_read_flags(VALUE flags) {
+    if (NIL_P(flags)) return 0;
+    yyjson_read_flag flg = (yyjson_read_flag)NUM2UINT(flags);
+    if (flg & YYJSON_READ_INSITU) {
+        rb_raise(rb_eArgError, "use insitu: true instead of the insitu read flag");
     }
+    return flg;
+}
 
-    if (RB_TYPE_P(obj, T_SYMBOL)) {
-        VALUE str = rb_sym2str(obj);
-        const char *cstr = RSTRING_PTR(str);
-        size_t len = RSTRING_LEN(str);
-        return yyjson_mut_strncpy(doc, cstr, len);
+/* Parse json_string with yyjson, raising ParseError on invalid input */
+static yyjson_doc *json_read_or_raise(VALUE json_string, yyjson_read_flag flg) {
+    const char *str = RSTRING_PTR(json_string);
+    size_t len = RSTRING_LEN(json_string);
+
+    yyjson_read_err err;
+    yyjson_doc *doc = yyjson_read_opts((char *)str, len, flg, NULL, &err);
+
+    if (!doc) json_raise_parse_error(&err, 0);
+    return doc;
+}
+
+/*
+ * Per-thread read arena. Documents whose worst-case parser memory fits are
+ * read into it with a pool allocator instead of a fresh malloc'd pool, and
+ * the arena is reused by the next parse on the same thread. It is only
+ * used by parse, whose documents are freed before it returns.
+ */
+#define JSON_READ_ARENA_SIZE (64 * 1024)
+
+#ifdef _MSC_VER
+#define JSON_THREAD_LOCAL __declspec(thread)
+#else
+#define JSON_THREAD_LOCAL __thread
+#endif
+
+static JSON_THREAD_LOCAL char json_read_arena[JSON_READ_ARENA_SIZE];
+static JSON_THREAD_LOCAL int json_read_arena_busy;
+
+typedef struct {
+    yyjson_alc alc;
+    int uses_arena;
+} json_read_alc_t;
+
+/* Allocator for a len-byte document: the thread arena when free and large enough, else NULL (malloc) */
+static const yyjson_alc *json_read_alc_acquire(json_read_alc_t *ra, size_t len, yyjson_read_flag flg) {
+    ra->uses_arena = 0;
+    if (json_read_arena_busy) return NULL;
+    size_t need = yyjson_read_max_memory_usage(len, flg);
+    if (need == 0 || need > JSON_READ_ARENA_SIZE - 64) return NULL;
+    if (!yyjson_alc_pool_init(&ra->alc, json_read_arena, JSON_READ_ARENA_SIZE)) return NULL;
+    json_read_arena_busy = 1;
+    ra->uses_arena = 1;
+    return &ra->alc;
+}
+
+static void json_read_alc_release(json_read_alc_t *ra) {
+    if (ra->uses_arena) {
+        json_read_arena_busy = 0;
+        ra->uses_arena = 0;
     }
+}
 
-    if (RB_TYPE_P(obj, T_ARRAY)) {
-        yyjson_mut_val *arr = yyjson_mut_arr(doc);
-        long len = RARRAY_LEN(obj);
-        for (long i = 0; i < len; i++) {
-            VALUE elem = rb_ary_entry(obj, i);
-            yyjson_mut_val *mut_elem = ruby_to_yyjson_mut(doc, elem);
-            yyjson_mut_arr_append(arr, mut_elem);
-        }
-        return arr;
+/*
+ * Inputs at least this large are read with the GVL released, so other Ruby
+ * threads keep running while yyjson works; the Ruby conversion that follows
+ * needs the GVL again.
+ */
+#define JSON_NOGVL_MIN_SIZE (32 * 1024)
+
+/* One yyjson_read call, runnable without the GVL (touches no Ruby objects) */
+typedef struct {
+    const char *str;
+    size_t len;
+    yyjson_read_flag flg;
+    const yyjson_alc *alc;
+    yyjson_read_err err;
+    yyjson_doc *doc;
+} json_read_job_t;
+
+static void *json_read_job_run(void *arg) {
+    json_read_job_t *job = (json_read_job_t *)arg;
+    job->doc = yyjson_read_opts((char *)job->str, job->len, job->flg, job->alc, &job->err);
+    return NULL;
+}
+
+static void json_read_job(json_read_job_t *job) {
+    if (job->len >= JSON_NOGVL_MIN_SIZE) {
+        rb_thread_call_without_gvl(json_read_job_run, job, NULL, NULL);
+    } else {
+        json_read_job_run(job);
     }
+}
 
-    if (RB_TYPE_P(obj, T_HASH)) {
-        yyjson_mut_val *hash_obj = yyjson_mut_obj(doc);
-        VALUE keys = rb_funcall(obj, rb_intern("keys"), 0);
-        long len = RARRAY_LEN(keys);
-        for (long i = 0; i < len; i++) {
-            VALUE key = rb_ary_entry(keys, i);
-            VALUE val = rb_hash_aref(obj, key);
-
-            /* Convert key to string */
-            VALUE key_str;
-            if (RB_TYPE_P(key, T_STRING)) {
-                key_str = key;
-            } else if (RB_TYPE_P(key, T_SYMBOL)) {
-                key_str = rb_sym2str(key);
-            } else {
-                key_str = rb_funcall(key, rb_intern("to_s"), 0);
-            }
+typedef struct {
+    json_parse_ctx_t ctx;
+    json_read_alc_t ra;
+    json_read_job_t job;
+    VALUE json_string;
+    int insitu;
+    int locked;
+} json_parse_state_t;
 
-            const char *key_cstr = RSTRING_PTR(key_str);
-            size_t key_len = RSTRING_LEN(key_str);
-            yyjson_mut_val *mut_key = yyjson_mut_strncpy(doc, key_cstr, key_len);
-            yyjson_mut_val *mut_val = ruby_to_yyjson_mut(doc, val);
-            yyjson_mut_obj_add(hash_obj, mut_key, mut_val);
-        }
-        return hash_obj;
-    }
-
-    /* For other objects, try to_json or to_s */
-    if (rb_respond_to(obj, rb_intern("to_json"))) {
-        VALUE json_str = rb_funcall(obj, rb_intern("to_json"), 0);
-        const char *str = RSTRING_PTR(json_str);
-        size_t len = RSTRING_LEN(json_str);
-        /* Parse and return as raw JSON */
-        yyjson_doc *inner_doc = yyjson_read(str, len, 0);
-        if (inner_doc) {
-            yyjson_val *root = yyjson_doc_get_root(inner_doc);
-            yyjson_mut_val *result = yyjson_val_mut_copy(doc, root);
-            yyjson_doc_free(inner_doc);
-            return result;
-        }
+/*
+ * Read and convert under rb_ensure, so the document and the arena are
+ * released even when the interrupt check after the no-GVL read raises.
+ */
+static VALUE json_parse_body(VALUE arg) {
+    json_parse_state_t *st = (json_parse_state_t *)arg;
+
+    /* An insitu read writes into json_string: lock it so no other thread can move its bytes */
+    if (st->insitu) {
+        rb_str_locktmp(st->json_string);
+        st->locked = 1;
+    }
+    json_read_job(&st->job);
+    if (st->insitu) {
+        rb_str_unlocktmp(st->json_string);
+        st->locked = 0;
+        rb_str_set_len(st->json_string, 0);
     }
 
-    /* Fallback: convert to string */
-    VALUE str = rb_funcall(obj, rb_intern("to_s"), 0);
-    const char *cstr = RSTRING_PTR(str);
-    size_t len = RSTRING_LEN(str);
-    return yyjson_mut_strncpy(doc, cstr, len);
+    if (!st->job.doc) json_raise_parse_error(&st->job.err, 0);
+    return yyjson_val_to_ruby(&st->ctx, yyjson_doc_get_root(st->job.doc));
+}
+
+static VALUE json_parse_ensure(VALUE arg) {
+    json_parse_state_t *st = (json_parse_state_t *)arg;
+    if (st->locked) rb_str_unlocktmp(st->json_string);
+    if (st->job.doc) yyjson_doc_free(st->job.doc);
+    json_read_alc_release(&st->ra);
+    return Qnil;
 }
 
 /*
  * Parse JSON string to Ruby object
  *
+ * flags combines the read flag constants (ALLOW_COMMENTS, ...). With
+ * NUMBER_AS_RAW or BIGNUM_AS_RAW numbers are kept as text by the parser and
+ * converted exactly: integers of any size become Integer instead of being
+ * rounded through a double.
+ *
+ * With insitu: true the input String is handed over to the parser: yyjson
+ * parses it in place (no copy of the input), and the String is emptied
+ * afterwards because its bytes have been overwritten. Frozen Strings
+ * cannot be given up and raise FrozenError. The String is locked while the
+ * parser writes into it, so other threads cannot modify it meanwhile.
+ *
  * @param json_string [String] JSON string to parse
+ * @param flags [Integer] read flags (default: 0)
+ * @param symbolize_names [Boolean] return object keys as Symbols (keyword, default: false)
+ * @param insitu [Boolean] parse in place, consuming json_string (keyword, default: false)
  * @return [Object] Ruby object (Hash, Array, String, Integer, Float, true, false, nil)
- * @raise [ArgumentError] if JSON is invalid
+ * @raise [KonpeitoJSON::ParseError] if JSON is invalid (an ArgumentError with #position)
  */
-VALUE konpeito_json_parse(VALUE self, VALUE json_string) {
+VALUE konpeito_json_parse(int argc, VALUE *argv, VALUE self) {
+    VALUE json_string, flags, opts;
+    rb_scan_args(argc, argv, "11:", &json_string, &flags, &opts);
     Check_Type(json_string, T_STRING);
+    yyjson_read_flag flg = json_read_flags(flags);
+
+    json_parse_state_t st;
+    memset(&st, 0, sizeof(st));
+    int insitu = 0;
+    if (!NIL_P(opts)) {
+        ID kw[2] = { id_symbolize_names, id_insitu };
+        VALUE vals[2];
+        rb_get_kwargs(opts, kw, 0, 2, vals);
+        st.ctx.symbolize_names = vals[0] != Qundef && RTEST(vals[0]);
+        insitu = vals[1] != Qundef && RTEST(vals[1]);
+    }
 
-    const char *str = RSTRING_PTR(json_string);
     size_t len = RSTRING_LEN(json_string);
+    if (insitu) {
+        /* yyjson needs YYJSON_PADDING_SIZE zero bytes after the input */
+        rb_str_modify_expand(json_string, YYJSON_PADDING_SIZE);
+        memset(RSTRING_PTR(json_string) + len, 0, YYJSON_PADDING_SIZE);
+        flg |= YYJSON_READ_INSITU;
+    }
 
-    yyjson_read_err err;
-    yyjson_doc *doc = yyjson_read_opts((char *)str, len, 0, NULL, &err);
+    /* Without the GVL, read from a frozen snapshot so other threads cannot move the bytes */
+    VALUE src = json_string;
+    if (!insitu && len >= JSON_NOGVL_MIN_SIZE) src = rb_str_new_frozen(json_string);
 
-    if (!doc) {
-        rb_raise(rb_eArgError, "JSON parse error at position %zu: %s",
-                 err.pos, err.msg);
-        return Qnil;
+    st.json_string = json_string;
+    st.insitu = insitu;
+    st.job.str = RSTRING_PTR(src);
+    st.job.len = len;
+    st.job.flg = flg;
+    st.job.alc = json_read_alc_acquire(&st.ra, len, flg);
+
+    VALUE result = rb_ensure(json_parse_body, (VALUE)&st, json_parse_ensure, (VALUE)&st);
+    RB_GC_GUARD(json_string);
+    RB_GC_GUARD(src);
+    return result;
+}
+
+/* Upper bound on parse_many worker threads */
+#define JSON_PARSE_MANY_MAX_THREADS 64
+
+/*
+ * parse_many work queue. Workers claim documents through an atomic index,
+ * so a thread that draws small documents simply takes more of them.
+ */
+typedef struct {
+    json_read_job_t *jobs;
+    long count;
+    long next;
+    size_t total;   /* input bytes over all documents */
+    int nthreads;
+    json_parse_ctx_t ctx;
+    VALUE sources;  /* frozen snapshots of the inputs, kept alive for the workers */
+} json_read_pool_t;
+
+static void *json_read_pool_worker(void *arg) {
+    json_read_pool_t *pool = (json_read_pool_t *)arg;
+    long i;
+    while ((i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED)) < pool->count) {
+        json_read_job_run(&pool->jobs[i]);
     }
+    return NULL;
+}
 
-    yyjson_val *root = yyjson_doc_get_root(doc);
-    VALUE result = yyjson_val_to_ruby(root);
+/* Called without the GVL: the calling thread works alongside nthreads - 1 helpers */
+static void *json_read_pool_run(void *arg) {
+    json_read_pool_t *pool = (json_read_pool_t *)arg;
+#ifndef _WIN32
+    pthread_t tids[JSON_PARSE_MANY_MAX_THREADS];
+    int started = 0;
+    for (int t = 1; t < pool->nthreads; t++) {
+        if (pthread_create(&tids[started], NULL, json_read_pool_worker, pool) != 0) break;
+        started++;
+    }
+    json_read_pool_worker(pool);
+    for (int t = 0; t < started; t++) pthread_join(tids[t], NULL);
+#else
+    json_read_pool_worker(pool);
+#endif
+    return NULL;
+}
 
-    yyjson_doc_free(doc);
-    return result;
+static int json_default_thread_count(void) {
+#ifndef _WIN32
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 0) return n > JSON_PARSE_MANY_MAX_THREADS ? JSON_PARSE_MANY_MAX_THREADS : (int)n;
+#endif
+    return 1;
 }
 
 /*
- * Generate JSON string from Ruby object
- *
- * @param obj [Object] Ruby object to convert
- * @return [String] JSON string
+ * Read the documents, then convert them in input order, freeing each as it
+ * is done. Runs under rb_ensure so the jobs and their documents are freed
+ * even when the interrupt check after the no-GVL read raises.
  */
-VALUE konpeito_json_generate(VALUE self, VALUE obj) {
-    yyjson_mut_doc *doc = yyjson_mut_doc_new(NULL);
-    if (!doc) {
-        rb_raise(rb_eNoMemError, "Failed to allocate JSON document");
-        return Qnil;
+static VALUE json_parse_many_body(VALUE arg) {
+    json_read_pool_t *pool = (json_read_pool_t *)arg;
+    if (pool->total < JSON_NOGVL_MIN_SIZE) {
+        json_read_pool_worker(pool);
+    } else {
+        rb_thread_call_without_gvl(json_read_pool_run, pool, NULL, NULL);
     }
 
-    yyjson_mut_val *root = ruby_to_yyjson_mut(doc, obj);
-    yyjson_mut_doc_set_root(doc, root);
+    VALUE result = rb_ary_new_capa(pool->count);
 
-    size_t len;
-    char *json_str = yyjson_mut_write(doc, 0, &len);
+    for (long i = 0; i < pool->count; i++) {
+        json_read_job_t *job = &pool->jobs[i];
+        if (!job->doc) {
+            json_raise_parse_error_msg(&job->err,
+                rb_sprintf("JSON parse error in document %ld at position %zu: %s",
+                           i, job->err.pos, job->err.msg));
+        }
+        rb_ary_push(result, yyjson_val_to_ruby(&pool->ctx, yyjson_doc_get_root(job->doc)));
+        yyjson_doc_free(job->doc);
+        job->doc = NULL;
+    }
+    return result;
+}
 
-    yyjson_mut_doc_free(doc);
+static VALUE json_parse_many_ensure(VALUE arg) {
+    json_read_pool_t *pool = (json_read_pool_t *)arg;
+    for (long i = 0; i < pool->count; i++) {
+        if (pool->jobs[i].doc) yyjson_doc_free(pool->jobs[i].doc);
+    }
+    ruby_xfree(pool->jobs);
+    return Qnil;
+}
 
-    if (!json_str) {
-        rb_raise(rb_eRuntimeError, "Failed to generate JSON");
-        return Qnil;
+/*
+ * Parse many JSON strings, reading them in parallel on native threads
+ *
+ * The yyjson reads run without the GVL on up to threads: threads; the
+ * results are then converted to Ruby objects in input order. Batches
+ * smaller than 32KB in total are parsed on the calling thread.
+ *
+ * @param json_strings [Array<String>] JSON strings to parse
+ * @param flags [Integer] read flags (default: 0)
+ * @param symbolize_names [Boolean] return object keys as Symbols (keyword, default: false)
+ * @param threads [Integer] worker threads (keyword, default: number of CPUs)
+ * @return [Array] parsed values, in the order of json_strings
+ * @raise [KonpeitoJSON::ParseError] for the first invalid document (by index)
+ */
+VALUE konpeito_json_parse_many(int argc, VALUE *argv, VALUE self) {
+    VALUE json_strings, flags, opts;
+    rb_scan_args(argc, argv, "11:", &json_strings, &flags, &opts);
+    Check_Type(json_strings, T_ARRAY);
+    yyjson_read_flag flg = json_read_flags(flags);
+
+    json_read_pool_t pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.nthreads = json_default_thread_count();
+    if (!NIL_P(opts)) {
+        ID kw[2] = { id_symbolize_names, id_threads };
+        VALUE vals[2];
+        rb_get_kwargs(opts, kw, 0, 2, vals);
+        pool.ctx.symbolize_names = vals[0] != Qundef && RTEST(vals[0]);
+        if (vals[1] != Qundef) {
+            int n = NUM2INT(vals[1]);
+            if (n < 1) rb_raise(rb_eArgError, "threads must be positive");
+            pool.nthreads = n > JSON_PARSE_MANY_MAX_THREADS ? JSON_PARSE_MANY_MAX_THREADS : n;
+        }
     }
 
-    VALUE result = rb_utf8_str_new(json_str, len);
-    free(json_str);
+    long count = RARRAY_LEN(json_strings);
+    pool.sources = rb_ary_new_capa(count);
+    for (long i = 0; i < count; i++) {
+        VALUE str = RARRAY_AREF(json_strings, i);
+        Check_Type(str, T_STRING);
+        rb_ary_push(pool.sources, rb_str_new_frozen(str));
+    }
 
+    pool.jobs = ruby_xcalloc(count > 0 ? count : 1, sizeof(json_read_job_t));
+    pool.count = count;
+    size_t total = 0;
+    for (long i = 0; i < count; i++) {
+        VALUE src = RARRAY_AREF(pool.sources, i);
+        pool.jobs[i].str = RSTRING_PTR(src);
+        pool.jobs[i].len = RSTRING_LEN(src);
+        pool.jobs[i].flg = flg;
+        total += pool.jobs[i].len;
+    }
+
+    pool.total = total;
+    if (pool.nthreads > count) pool.nthreads = count > 0 ? (int)count : 1;
+
+    VALUE result = rb_ensure(json_parse_many_body, (VALUE)&pool, json_parse_many_ensure, (VALUE)&pool);
+    RB_GC_GUARD(pool.sources);
     return result;
 }
 
+/*
+ * Generate JSON string from Ruby object
+ *
+ * @param obj [Object] Ruby object to convert
+ * @return [String] JSON string
+ */
+VALUE konpeito_json_generate(VALUE self, VALUE obj) {
+    return json_write(obj, 0, json_writer_value);
+}
+
 /*
  * Generate pretty-printed JSON string from Ruby object
  *
@@ -241,40 +609,677 @@ VALUE konpeito_json_generate(VALUE self, VALUE obj) {
  */
 VALUE konpeito_json_generate_pretty(VALUE self, VALUE obj, VALUE indent) {
     int indent_spaces = NUM2INT(indent);
-    (void)indent_spaces; /* yyjson uses fixed 4-space indent for pretty print */
+    (void)indent_spaces; /* fixed 4-space indent, matching yyjson's pretty writer */
 
-    yyjson_mut_doc *doc = yyjson_mut_doc_new(NULL);
-    if (!doc) {
-        rb_raise(rb_eNoMemError, "Failed to allocate JSON document");
-        return Qnil;
+    return json_write(obj, 1, json_writer_value);
+}
+
+/*
+ * Generate a JSON object from an object's fields
+ *
+ * Each instance variable becomes a key (without the leading @), in
+ * definition order. Compiled code specializes this per NativeClass.
+ *
+ * @param obj [Object] object to convert
+ * @return [String] JSON string
+ */
+VALUE konpeito_json_generate_as(VALUE self, VALUE obj) {
+    return json_write(obj, 0, json_writer_fields);
+}
+
+/*
+ * Generate a JSON array of field objects (see generate_as)
+ *
+ * @param objects [Array] objects to convert
+ * @return [String] JSON string
+ * @raise [TypeError] if objects is not an Array
+ */
+VALUE konpeito_json_generate_array_as(VALUE self, VALUE objects) {
+    return json_write(objects, 0, json_writer_fields_array);
+}
+
+/*
+ * Lazy document handle
+ *
+ * KonpeitoJSON.open keeps the immutable yyjson_doc alive inside a
+ * KonpeitoJSON::Document and only converts the values that are looked up.
+ * Containers come back as KonpeitoJSON::View objects pointing into the
+ * document; scalars are converted directly.
+ */
+
+typedef struct {
+    yyjson_doc *doc;
+    int symbolize_names;
+} json_document_t;
+
+typedef struct {
+    VALUE document;  /* owning KonpeitoJSON::Document, keeps the doc alive */
+    yyjson_val *val;
+} json_view_t;
+
+static VALUE cDocument;
+static VALUE cView;
+
+static void json_document_free(void *ptr) {
+    json_document_t *d = (json_document_t *)ptr;
+    if (d->doc) yyjson_doc_free(d->doc);
+    xfree(d);
+}
+
+static size_t json_document_memsize(const void *ptr) {
+    const json_document_t *d = (const json_document_t *)ptr;
+    size_t size = sizeof(*d);
+    if (d->doc) {
+        size += yyjson_doc_get_val_count(d->doc) * sizeof(yyjson_val) +
+                yyjson_doc_get_read_size(d->doc);
     }
+    return size;
+}
 
-    yyjson_mut_val *root = ruby_to_yyjson_mut(doc, obj);
-    yyjson_mut_doc_set_root(doc, root);
+static const rb_data_type_t json_document_type = {
+    "KonpeitoJSON::Document",
+    { NULL, json_document_free, json_document_memsize, },
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
 
-    size_t len;
-    char *json_str = yyjson_mut_write(doc, YYJSON_WRITE_PRETTY, &len);
+static void json_view_mark(void *ptr) {
+    json_view_t *v = (json_view_t *)ptr;
+    rb_gc_mark(v->document);
+}
 
-    yyjson_mut_doc_free(doc);
+static const rb_data_type_t json_view_type = {
+    "KonpeitoJSON::View",
+    { json_view_mark, RUBY_TYPED_DEFAULT_FREE, NULL, },
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
 
-    if (!json_str) {
-        rb_raise(rb_eRuntimeError, "Failed to generate JSON");
-        return Qnil;
+static json_document_t *json_document_get(VALUE self) {
+    json_document_t *d;
+    TypedData_Get_Struct(self, json_document_t, &json_document_type, d);
+    return d;
+}
+
+static json_view_t *json_view_get(VALUE self) {
+    json_view_t *v;
+    TypedData_Get_Struct(self, json_view_t, &json_view_type, v);
+    return v;
+}
+
+/* Convert a value fully; the key cache is only set up for containers */
+static VALUE json_materialize(yyjson_val *val, int symbolize_names) {
+    if (!yyjson_is_ctn(val)) {
+        return yyjson_val_to_ruby(NULL, val);
     }
+    json_parse_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.symbolize_names = symbolize_names;
+    return yyjson_val_to_ruby(&ctx, val);
+}
 
-    VALUE result = rb_utf8_str_new(json_str, len);
-    free(json_str);
+/* Wrap a looked-up value: View for containers, Ruby object for scalars */
+static VALUE json_view_wrap(VALUE document, yyjson_val *val) {
+    if (!val) return Qnil;
+    if (!yyjson_is_ctn(val)) {
+        return yyjson_val_to_ruby(NULL, val);
+    }
+    json_view_t *v;
+    VALUE view = TypedData_Make_Struct(cView, json_view_t, &json_view_type, v);
+    v->document = document;
+    v->val = val;
+    return view;
+}
 
-    return result;
+/* Resolve an RFC 6901 JSON pointer relative to val */
+static yyjson_val *json_pointer_get(yyjson_val *val, VALUE pointer) {
+    Check_Type(pointer, T_STRING);
+    return yyjson_ptr_getn(val, RSTRING_PTR(pointer), RSTRING_LEN(pointer));
+}
+
+/* Look up an object key (String/Symbol) or array index (Integer) */
+static yyjson_val *json_child_get(yyjson_val *val, VALUE key) {
+    if (yyjson_is_obj(val)) {
+        VALUE key_str;
+        if (RB_TYPE_P(key, T_SYMBOL)) {
+            key_str = rb_sym2str(key);
+        } else {
+            Check_Type(key, T_STRING);
+            key_str = key;
+        }
+        return yyjson_obj_getn(val, RSTRING_PTR(key_str), RSTRING_LEN(key_str));
+    }
+    if (yyjson_is_arr(val)) {
+        long idx = NUM2LONG(key);
+        long size = (long)yyjson_arr_size(val);
+        if (idx < 0) idx += size;
+        if (idx < 0 || idx >= size) return NULL;
+        return yyjson_arr_get(val, (size_t)idx);
+    }
+    return NULL;
+}
+
+/*
+ * Open a JSON document for on-demand access
+ *
+ * With NUMBER_AS_RAW the parser skips number conversion entirely; each
+ * number is converted only when it is looked up.
+ *
+ * @param json_string [String] JSON string to parse
+ * @param flags [Integer] read flags (default: 0)
+ * @param symbolize_names [Boolean] return object keys as Symbols when values are converted (keyword, default: false)
+ * @return [KonpeitoJSON::Document] document handle
+ * @raise [KonpeitoJSON::ParseError] if JSON is invalid
+ */
+VALUE konpeito_json_open(int argc, VALUE *argv, VALUE self) {
+    VALUE json_string, flags, opts;
+    rb_scan_args(argc, argv, "11:", &json_string, &flags, &opts);
+    Check_Type(json_string, T_STRING);
+    yyjson_read_flag flg = json_read_flags(flags);
+
+    json_document_t *d;
+    VALUE document = TypedData_Make_Struct(cDocument, json_document_t, &json_document_type, d);
+    d->symbolize_names = json_opt_symbolize_names(opts);
+    d->doc = json_read_or_raise(json_string, flg);
+    return document;
+}
+
+/*
+ * Look up a value by JSON pointer and convert only that value
+ *
+ * @param pointer [String] RFC 6901 JSON pointer, e.g. "/data/0/id" ("" is the root)
+ * @return [Object, nil] converted value, or nil if the pointer does not resolve
+ */
+static VALUE json_document_at(VALUE self, VALUE pointer) {
+    json_document_t *d = json_document_get(self);
+    yyjson_val *val = json_pointer_get(yyjson_doc_get_root(d->doc), pointer);
+    return val ? json_materialize(val, d->symbolize_names) : Qnil;
+}
+
+/*
+ * Root value: a View for objects/arrays, a Ruby object for scalars
+ */
+static VALUE json_document_root(VALUE self) {
+    json_document_t *d = json_document_get(self);
+    return json_view_wrap(self, yyjson_doc_get_root(d->doc));
+}
+
+/*
+ * Child of the root by key or index (see View#[])
+ */
+static VALUE json_document_aref(VALUE self, VALUE key) {
+    json_document_t *d = json_document_get(self);
+    return json_view_wrap(self, json_child_get(yyjson_doc_get_root(d->doc), key));
+}
+
+/*
+ * Convert the whole document (same result as KonpeitoJSON.parse)
+ */
+static VALUE json_document_to_ruby(VALUE self) {
+    json_document_t *d = json_document_get(self);
+    return json_materialize(yyjson_doc_get_root(d->doc), d->symbolize_names);
+}
+
+/*
+ * Child by object key (String or Symbol) or array index (Integer).
+ * Objects and arrays are returned as Views, scalars as Ruby objects,
+ * and nil if the child does not exist.
+ */
+static VALUE json_view_aref(VALUE self, VALUE key) {
+    json_view_t *v = json_view_get(self);
+    return json_view_wrap(v->document, json_child_get(v->val, key));
+}
+
+/*
+ * Look up a value by JSON pointer relative to this view and convert it
+ */
+static VALUE json_view_at(VALUE self, VALUE pointer) {
+    json_view_t *v = json_view_get(self);
+    yyjson_val *val = json_pointer_get(v->val, pointer);
+    return val ? json_materialize(val, json_document_get(v->document)->symbolize_names) : Qnil;
+}
+
+/* Number of object members or array elements */
+static VALUE json_view_size(VALUE self) {
+    json_view_t *v = json_view_get(self);
+    return SIZET2NUM(yyjson_get_len(v->val));
+}
+
+/* Object keys (empty Array for arrays) */
+static VALUE json_view_keys(VALUE self) {
+    json_view_t *v = json_view_get(self);
+    json_document_t *d = json_document_get(v->document);
+    VALUE keys = rb_ary_new();
+    if (!yyjson_is_obj(v->val)) return keys;
+
+    yyjson_obj_iter iter;
+    yyjson_obj_iter_init(v->val, &iter);
+    yyjson_val *key;
+    while ((key = yyjson_obj_iter_next(&iter))) {
+        VALUE fstr = rb_enc_interned_str(yyjson_get_str(key), (long)yyjson_get_len(key),
+                                         rb_utf8_encoding());
+        rb_ary_push(keys, d->symbolize_names ? rb_str_intern(fstr) : fstr);
+    }
+    return keys;
+}
+
+static VALUE json_view_object_p(VALUE self) {
+    return yyjson_is_obj(json_view_get(self)->val) ? Qtrue : Qfalse;
+}
+
+static VALUE json_view_array_p(VALUE self) {
+    return yyjson_is_arr(json_view_get(self)->val) ? Qtrue : Qfalse;
+}
+
+/* Convert this subtree fully */
+static VALUE json_view_to_ruby(VALUE self) {
+    json_view_t *v = json_view_get(self);
+    return json_materialize(v->val, json_document_get(v->document)->symbolize_names);
+}
+
+/*
+ * NDJSON (JSON Lines) streaming
+ *
+ * The reader pulls large chunks from an IO into one reused String and
+ * parses each line with a yyjson allocator that lives for the whole call,
+ * so memory stays flat regardless of input size. The object key cache is
+ * shared across lines as well. The writer appends lines into a buffer and
+ * hands it to the IO in batches.
+ */
+
+/* Bytes requested from the IO per read */
+#define NDJSON_READ_CHUNK_SIZE (256 * 1024)
+
+/* Buffered output is written to the IO once it grows past this size */
+#define NDJSON_WRITE_BUFFER_SIZE (64 * 1024)
+
+typedef struct {
+    VALUE io;
+    int owns_io;
+    VALUE chunk;            /* reused read buffer */
+    char *carry;            /* partial line spanning two chunks */
+    size_t carry_len;
+    size_t carry_capa;
+    yyjson_alc *alc;        /* shared by every line of this call */
+    int raw;                /* yield line Strings instead of parsed values */
+    long lineno;
+    json_parse_ctx_t ctx;
+} json_ndjson_reader_t;
+
+static ID id_read;
+static ID id_write;
+static ID id_flush;
+static ID id_raw;
+
+static VALUE cNDJSONWriter;
+
+/* Open a path for binary reading/writing, or use the given IO as is */
+static VALUE ndjson_open_io(VALUE dest, const char *mode, int *owns_io) {
+    if (RB_TYPE_P(dest, T_STRING)) {
+        *owns_io = 1;
+        return rb_file_open_str(dest, mode);
+    }
+    *owns_io = 0;
+    return dest;
+}
+
+/* Parse (or pass through) one line and yield it; blank lines are skipped */
+static void ndjson_yield_line(json_ndjson_reader_t *r, const char *line, size_t len) {
+    r->lineno++;
+
+    if (len > 0 && line[len - 1] == '\r') len--;
+    size_t i = 0;
+    while (i < len && (line[i] == ' ' || line[i] == '\t')) i++;
+    if (i == len) return;
+
+    if (r->raw) {
+        rb_yield(rb_utf8_str_new(line, (long)len));
+        return;
+    }
+
+    yyjson_read_err err;
+    yyjson_doc *doc = yyjson_read_opts((char *)line, len, 0, r->alc, &err);
+    if (!doc) json_raise_parse_error(&err, r->lineno);
+    VALUE obj = yyjson_val_to_ruby(&r->ctx, yyjson_doc_get_root(doc));
+    yyjson_doc_free(doc);
+
+    rb_yield(obj);
+}
+
+static void ndjson_carry_append(json_ndjson_reader_t *r, const char *data, size_t len) {
+    if (r->carry_len + len > r->carry_capa) {
+        size_t new_capa = r->carry_capa ? r->carry_capa * 2 : NDJSON_READ_CHUNK_SIZE;
+        while (new_capa < r->carry_len + len) new_capa *= 2;
+        REALLOC_N(r->carry, char, new_capa);
+        r->carry_capa = new_capa;
+    }
+    memcpy(r->carry + r->carry_len, data, len);
+    r->carry_len += len;
+}
+
+static VALUE ndjson_each_body(VALUE arg) {
+    json_ndjson_reader_t *r = (json_ndjson_reader_t *)arg;
+    VALUE chunk_size = LONG2NUM(NDJSON_READ_CHUNK_SIZE);
+
+    while (!NIL_P(rb_funcall(r->io, id_read, 2, chunk_size, r->chunk))) {
+        Check_Type(r->chunk, T_STRING);
+        size_t chunk_len = RSTRING_LEN(r->chunk);
+        size_t pos = 0;
+
+        while (pos < chunk_len) {
+            /* Re-fetch the pointer: the block may have run since the last line */
+            const char *base = RSTRING_PTR(r->chunk);
+            const char *nl = memchr(base + pos, '\n', chunk_len - pos);
+            if (!nl) {
+                ndjson_carry_append(r, base + pos, chunk_len - pos);
+                break;
+            }
+
+            size_t line_len = (size_t)(nl - (base + pos));
+            if (r->carry_len > 0) {
+                /* Complete the line that started in an earlier chunk */
+                ndjson_carry_append(r, base + pos, line_len);
+                size_t len = r->carry_len;
+                r->carry_len = 0;
+                ndjson_yield_line(r, r->carry, len);
+            } else {
+                ndjson_yield_line(r, base + pos, line_len);
+            }
+            pos += line_len + 1;
+        }
+    }
+
+    /* Last line without a trailing newline */
+    if (r->carry_len > 0) {
+        size_t len = r->carry_len;
+        r->carry_len = 0;
+        ndjson_yield_line(r, r->carry, len);
+    }
+
+    return Qnil;
+}
+
+static VALUE ndjson_each_ensure(VALUE arg) {
+    json_ndjson_reader_t *r = (json_ndjson_reader_t *)arg;
+    xfree(r->carry);
+    r->carry = NULL;
+    if (r->alc) {
+        yyjson_alc_dyn_free(r->alc);
+        r->alc = NULL;
+    }
+    if (r->owns_io) {
+        rb_io_close(r->io);
+    }
+    return Qnil;
+}
+
+/*
+ * Iterate over an NDJSON (JSON Lines) source, one value per line
+ *
+ * @param source [String, IO] file path, or any object responding to read(len, buf)
+ * @param symbolize_names [Boolean] return object keys as Symbols (keyword, default: false)
+ * @param raw [Boolean] yield each line as a String instead of parsing it, e.g. for
+ *   KonpeitoJSON.parse_as (keyword, default: false)
+ * @yield [Object] parsed value (or line String) for each non-blank line
+ * @return [nil]
+ * @raise [ArgumentError] if a line is not valid JSON
+ */
+VALUE konpeito_json_each_ndjson(int argc, VALUE *argv, VALUE self) {
+    VALUE source, opts;
+    rb_scan_args(argc, argv, "1:", &source, &opts);
+    RETURN_ENUMERATOR(self, argc, argv);
+
+    json_ndjson_reader_t r;
+    memset(&r, 0, sizeof(r));
+    if (!NIL_P(opts)) {
+        ID kw[2] = { id_symbolize_names, id_raw };
+        VALUE vals[2];
+        rb_get_kwargs(opts, kw, 0, 2, vals);
+        r.ctx.symbolize_names = vals[0] != Qundef && RTEST(vals[0]);
+        r.raw = vals[1] != Qundef && RTEST(vals[1]);
+    }
+
+    r.alc = yyjson_alc_dyn_new();
+    if (!r.alc) {
+        rb_raise(rb_eNoMemError, "Failed to allocate JSON allocator");
+    }
+    r.chunk = rb_str_buf_new(NDJSON_READ_CHUNK_SIZE);
+    r.io = ndjson_open_io(source, "rb", &r.owns_io);
+
+    rb_ensure(ndjson_each_body, (VALUE)&r, ndjson_each_ensure, (VALUE)&r);
+    RB_GC_GUARD(r.chunk);
+    return Qnil;
+}
+
+typedef struct {
+    VALUE io;
+    VALUE buf;
+    int owns_io;
+    int closed;
+} json_ndjson_writer_t;
+
+static void json_ndjson_writer_mark(void *ptr) {
+    json_ndjson_writer_t *nw = (json_ndjson_writer_t *)ptr;
+    rb_gc_mark(nw->io);
+    rb_gc_mark(nw->buf);
+}
+
+static const rb_data_type_t json_ndjson_writer_type = {
+    "KonpeitoJSON::NDJSONWriter",
+    { json_ndjson_writer_mark, RUBY_TYPED_DEFAULT_FREE, NULL, },
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE json_ndjson_writer_alloc(VALUE klass) {
+    json_ndjson_writer_t *nw;
+    VALUE obj = TypedData_Make_Struct(klass, json_ndjson_writer_t, &json_ndjson_writer_type, nw);
+    nw->io = Qnil;
+    nw->buf = Qnil;
+    return obj;
+}
+
+static json_ndjson_writer_t *json_ndjson_writer_get(VALUE self) {
+    json_ndjson_writer_t *nw;
+    TypedData_Get_Struct(self, json_ndjson_writer_t, &json_ndjson_writer_type, nw);
+    if (NIL_P(nw->io)) {
+        rb_raise(rb_eRuntimeError, "uninitialized NDJSONWriter");
+    }
+    if (nw->closed) {
+        rb_raise(rb_eIOError, "closed NDJSONWriter");
+    }
+    return nw;
+}
+
+static VALUE json_ndjson_writer_buf_new(void) {
+    VALUE buf = rb_str_buf_new(NDJSON_WRITE_BUFFER_SIZE);
+    rb_enc_associate_index(buf, rb_utf8_encindex());
+    return buf;
+}
+
+/*
+ * Hand the buffered lines to the IO. The IO keeps the String (an Array
+ * or Queue sink may retain it), so the writer continues in a new buffer.
+ */
+static void json_ndjson_writer_drain(json_ndjson_writer_t *nw) {
+    if (RSTRING_LEN(nw->buf) == 0) return;
+    VALUE out = nw->buf;
+    nw->buf = json_ndjson_writer_buf_new();
+    rb_funcall(nw->io, id_write, 1, out);
+}
+
+/*
+ * Create a batched NDJSON writer
+ *
+ * @param dest [String, IO] file path (created/truncated), or any object responding to write
+ */
+static VALUE json_ndjson_writer_initialize(VALUE self, VALUE dest) {
+    json_ndjson_writer_t *nw;
+    TypedData_Get_Struct(self, json_ndjson_writer_t, &json_ndjson_writer_type, nw);
+
+    nw->buf = json_ndjson_writer_buf_new();
+    nw->io = ndjson_open_io(dest, "wb", &nw->owns_io);
+    return self;
+}
+
+typedef struct {
+    json_writer_t *w;
+    VALUE obj;
+} json_ndjson_line_arg_t;
+
+static VALUE json_ndjson_write_line(VALUE arg) {
+    json_ndjson_line_arg_t *a = (json_ndjson_line_arg_t *)arg;
+    json_writer_value(a->w, a->obj);
+    json_writer_byte(a->w, '\n');
+    return Qnil;
+}
+
+/*
+ * Append one value as a line; output reaches the IO in batches
+ *
+ * @param obj [Object] value to serialize
+ * @return [self]
+ */
+static VALUE json_ndjson_writer_write(VALUE self, VALUE obj) {
+    json_ndjson_writer_t *nw = json_ndjson_writer_get(self);
+
+    json_writer_t w;
+    w.buf = nw->buf;
+    w.len = RSTRING_LEN(nw->buf);
+    w.pretty = 0;
+    w.depth = 0;
+
+    /* On failure drop the partial line so the buffer stays line-aligned */
+    size_t start = w.len;
+    json_ndjson_line_arg_t arg = { &w, obj };
+    int state = 0;
+    rb_protect(json_ndjson_write_line, (VALUE)&arg, &state);
+    if (state) {
+        rb_str_set_len(nw->buf, (long)start);
+        rb_jump_tag(state);
+    }
+    rb_str_set_len(nw->buf, (long)w.len);
+
+    if (w.len >= NDJSON_WRITE_BUFFER_SIZE) {
+        json_ndjson_writer_drain(nw);
+    }
+    return self;
+}
+
+/* Write out buffered lines and flush the IO */
+static VALUE json_ndjson_writer_flush(VALUE self) {
+    json_ndjson_writer_t *nw = json_ndjson_writer_get(self);
+    json_ndjson_writer_drain(nw);
+    if (rb_respond_to(nw->io, id_flush)) {
+        rb_funcall(nw->io, id_flush, 0);
+    }
+    return self;
+}
+
+/* Mark the writer closed and close an IO it opened, even if the flush raised */
+static VALUE json_ndjson_writer_close_ensure(VALUE self) {
+    json_ndjson_writer_t *nw;
+    TypedData_Get_Struct(self, json_ndjson_writer_t, &json_ndjson_writer_type, nw);
+    nw->closed = 1;
+    if (nw->owns_io) {
+        rb_io_close(nw->io);
+    }
+    return Qnil;
+}
+
+/* Flush, and close the IO if the writer opened it from a path */
+static VALUE json_ndjson_writer_close(VALUE self) {
+    json_ndjson_writer_t *nw;
+    TypedData_Get_Struct(self, json_ndjson_writer_t, &json_ndjson_writer_type, nw);
+    if (nw->closed || NIL_P(nw->io)) return Qnil;
+
+    rb_ensure(json_ndjson_writer_flush, self, json_ndjson_writer_close_ensure, self);
+    return Qnil;
+}
+
+typedef struct {
+    VALUE writer;
+    VALUE objects;
+} json_write_ndjson_arg_t;
+
+static VALUE json_write_ndjson_body(VALUE arg) {
+    json_write_ndjson_arg_t *a = (json_write_ndjson_arg_t *)arg;
+    for (long i = 0; i < RARRAY_LEN(a->objects); i++) {
+        json_ndjson_writer_write(a->writer, RARRAY_AREF(a->objects, i));
+    }
+    return Qnil;
+}
+
+/*
+ * Write an Array of values as NDJSON, one line each
+ *
+ * @param dest [String, IO] file path (created/truncated), or any object responding to write
+ * @param objects [Array] values to serialize
+ * @return [Integer] number of lines written
+ */
+VALUE konpeito_json_write_ndjson(VALUE self, VALUE dest, VALUE objects) {
+    Check_Type(objects, T_ARRAY);
+
+    json_write_ndjson_arg_t arg;
+    arg.writer = rb_class_new_instance(1, &dest, cNDJSONWriter);
+    arg.objects = objects;
+    rb_ensure(json_write_ndjson_body, (VALUE)&arg, json_ndjson_writer_close, arg.writer);
+    return LONG2NUM(RARRAY_LEN(objects));
 }
 
 /* Module initialization - called by Init_<extension_name> */
 void Init_konpeito_json(void) {
     VALUE mKonpeitoJSON = rb_define_module("KonpeitoJSON");
 
-    rb_define_module_function(mKonpeitoJSON, "parse", konpeito_json_parse, 1);
+    id_symbolize_names = rb_intern("symbolize_names");
+    json_writer_init_ids();
+    id_insitu = rb_intern("insitu");
+    id_threads = rb_intern("threads");
+    id_at_position = rb_intern("@position");
+    id_read = rb_intern("read");
+    id_write = rb_intern("write");
+    id_flush = rb_intern("flush");
+    id_raw = rb_intern("raw");
+
+    /* Invalid input; #position is the byte offset reported by yyjson */
+    eParseError = rb_define_class_under(mKonpeitoJSON, "ParseError", rb_eArgError);
+    rb_define_attr(eParseError, "position", 1, 0);
+
+    rb_define_module_function(mKonpeitoJSON, "parse", konpeito_json_parse, -1);
+    rb_define_module_function(mKonpeitoJSON, "parse_many", konpeito_json_parse_many, -1);
     rb_define_module_function(mKonpeitoJSON, "generate", konpeito_json_generate, 1);
     rb_define_module_function(mKonpeitoJSON, "generate_pretty", konpeito_json_generate_pretty, 2);
+    rb_define_module_function(mKonpeitoJSON, "generate_as", konpeito_json_generate_as, 1);
+    rb_define_module_function(mKonpeitoJSON, "generate_array_as", konpeito_json_generate_array_as, 1);
+    rb_define_module_function(mKonpeitoJSON, "open", konpeito_json_open, -1);
+
+    /* Lazy document handle returned by open */
+    cDocument = rb_define_class_under(mKonpeitoJSON, "Document", rb_cObject);
+    rb_undef_alloc_func(cDocument);
+    rb_define_method(cDocument, "at", json_document_at, 1);
+    rb_define_method(cDocument, "root", json_document_root, 0);
+    rb_define_method(cDocument, "[]", json_document_aref, 1);
+    rb_define_method(cDocument, "to_ruby", json_document_to_ruby, 0);
+
+    /* View into an object or array of an open Document */
+    cView = rb_define_class_under(mKonpeitoJSON, "View", rb_cObject);
+    rb_undef_alloc_func(cView);
+    rb_define_method(cView, "at", json_view_at, 1);
+    rb_define_method(cView, "[]", json_view_aref, 1);
+    rb_define_method(cView, "size", json_view_size, 0);
+    rb_define_method(cView, "keys", json_view_keys, 0);
+    rb_define_method(cView, "object?", json_view_object_p, 0);
+    rb_define_method(cView, "array?", json_view_array_p, 0);
+    rb_define_method(cView, "to_ruby", json_view_to_ruby, 0);
+
+    /* NDJSON (JSON Lines) streaming */
+    rb_define_module_function(mKonpeitoJSON, "each_ndjson", konpeito_json_each_ndjson, -1);
+    rb_define_module_function(mKonpeitoJSON, "write_ndjson", konpeito_json_write_ndjson, 2);
+
+    cNDJSONWriter = rb_define_class_under(mKonpeitoJSON, "NDJSONWriter", rb_cObject);
+    rb_define_alloc_func(cNDJSONWriter, json_ndjson_writer_alloc);
+    rb_define_method(cNDJSONWriter, "initialize", json_ndjson_writer_initialize, 1);
+    rb_define_method(cNDJSONWriter, "write", json_ndjson_writer_write, 1);
+    rb_define_method(cNDJSONWriter, "<<", json_ndjson_writer_write, 1);
+    rb_define_method(cNDJSONWriter, "flush", json_ndjson_writer_flush, 0);
+    rb_define_method(cNDJSONWriter, "close", json_ndjson_writer_close, 0);
 
     /* Parse flags as constants */
     rb_define_const(mKonpeitoJSON, "ALLOW_COMMENTS",
@@ -283,4 +1288,8 @@ void Init_konpeito_json(void) {
                     UINT2NUM(YYJSON_READ_ALLOW_TRAILING_COMMAS));
     rb_define_const(mKonpeitoJSON, "ALLOW_INF_NAN",
                     UINT2NUM(YYJSON_READ_ALLOW_INF_AND_NAN));
+    rb_define_const(mKonpeitoJSON, "NUMBER_AS_RAW",
+                    UINT2NUM(YYJSON_READ_NUMBER_AS_RAW));
+    rb_define_const(mKonpeitoJSON, "BIGNUM_AS_RAW",
+                    UINT2NUM(YYJSON_READ_BIGNUM_AS_RAW));
 }
@@ -0,0 +1,326 @@
+/*
+ * Konpeito JSON stdlib - streaming JSON writer
+ *
+ * Shared by the konpeito_json extension (KonpeitoJSON.generate) and the
+ * runtime linked into compiled code for KonpeitoJSON.generate_as.
+ */
+
+#ifndef KONPEITO_JSON_WRITER_H
+#define KONPEITO_JSON_WRITER_H
+
+#include <ruby.h>
+#include <ruby/encoding.h>
+#include <string.h>
+#include <math.h>
+#include "../../../../vendor/yyjson/yyjson.h"
+
+/* Initial capacity of the output String; it grows geometrically from here */
+#define JSON_WRITER_INITIAL_CAPA 256
+
+/*
+ * Streaming writer state. JSON is appended straight into a Ruby String;
+ * `len` tracks the bytes written so far and is stored back into the String
+ * when the writer finishes.
+ */
+typedef struct {
+    VALUE buf;
+    size_t len;
+    int pretty;
+    int depth;
+} json_writer_t;
+
+/* Method IDs used for objects without a JSON mapping; see json_writer_init_ids */
+static ID json_writer_id_to_json;
+static ID json_writer_id_to_s;
+
+static void json_writer_init_ids(void) {
+    json_writer_id_to_json = rb_intern("to_json");
+    json_writer_id_to_s = rb_intern("to_s");
+}
+
+/* Bytes that must be escaped inside a JSON string (0 = copy as is) */
+static const char json_escape_table[256] = {
+    /* 0x00-0x1F: control characters */
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+};
+
+/* Grow the buffer geometrically so that n more bytes fit */
+static void json_writer_grow(json_writer_t *w, size_t n) {
+    size_t new_capa = rb_str_capacity(w->buf) * 2;
+    if (new_capa < w->len + n) new_capa = w->len + n;
+    /* Sync the length first so the written bytes survive reallocation */
+    rb_str_set_len(w->buf, (long)w->len);
+    rb_str_modify_expand(w->buf, (long)(new_capa - w->len));
+}
+
+/* Make room for at least n more bytes and return the write position */
+static inline char *json_writer_reserve(json_writer_t *w, size_t n) {
+    if (w->len + n > rb_str_capacity(w->buf)) {
+        json_writer_grow(w, n);
+    }
+    return RSTRING_PTR(w->buf) + w->len;
+}
+
+static inline void json_writer_append(json_writer_t *w, const char *data, size_t n) {
+    char *p = json_writer_reserve(w, n);
+    memcpy(p, data, n);
+    w->len += n;
+}
+
+static inline void json_writer_byte(json_writer_t *w, char c) {
+    char *p = json_writer_reserve(w, 1);
+    *p = c;
+    w->len++;
+}
+
+static void json_writer_long(json_writer_t *w, long num) {
+    char tmp[24];
+    char *p = tmp + sizeof(tmp);
+    unsigned long u = num < 0 ? 0UL - (unsigned long)num : (unsigned long)num;
+    do {
+        *--p = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (num < 0) *--p = '-';
+    json_writer_append(w, p, (size_t)(tmp + sizeof(tmp) - p));
+}
+
+/* Doubles go through yyjson's shortest round-trip formatter */
+static void json_writer_double(json_writer_t *w, double num) {
+    char pool_buf[256];
+    yyjson_alc alc;
+    yyjson_alc_pool_init(&alc, pool_buf, sizeof(pool_buf));
+
+    yyjson_val val;
+    unsafe_yyjson_set_real(&val, num);
+
+    size_t len;
+    char *str = yyjson_val_write_opts(&val, 0, &alc, &len, NULL);
+    if (!str) {
+        rb_raise(rb_eRuntimeError, "Failed to generate JSON: %s is not allowed",
+                 isnan(num) ? "NaN" : "Infinity");
+    }
+    json_writer_append(w, str, len);
+}
+
+/*
+ * Return str as valid UTF-8 bytes. Binary strings are taken as UTF-8 (as
+ * yyjson did), other encodings are transcoded.
+ */
+static VALUE json_utf8_string(VALUE str) {
+    int cr = rb_enc_str_coderange(str);
+    if (cr == ENC_CODERANGE_7BIT) return str;
+
+    int encidx = ENCODING_GET(str);
+    if (encidx != rb_utf8_encindex()) {
+        if (encidx == rb_ascii8bit_encindex()) {
+            str = rb_enc_associate_index(rb_str_dup(str), rb_utf8_encindex());
+        } else {
+            str = rb_str_conv_enc(str, rb_enc_from_index(encidx), rb_utf8_encoding());
+        }
+        cr = rb_enc_str_coderange(str);
+    }
+
+    if (cr == ENC_CODERANGE_BROKEN || ENCODING_GET(str) != rb_utf8_encindex()) {
+        rb_raise(rb_eRuntimeError, "Failed to generate JSON: invalid UTF-8 string");
+    }
+    return str;
+}
+
+/* Write a quoted, escaped JSON string */
+static void json_writer_string(json_writer_t *w, VALUE str) {
+    static const char hex[] = "0123456789ABCDEF";
+
+    str = json_utf8_string(str);
+    const unsigned char *src = (const unsigned char *)RSTRING_PTR(str);
+    size_t len = RSTRING_LEN(str);
+
+    /* Copy runs of plain bytes as they are; reserve room per escape only */
+    json_writer_byte(w, '"');
+
+    size_t i = 0;
+    while (i < len) {
+        size_t run = i;
+        while (run < len && !json_escape_table[src[run]]) run++;
+        json_writer_append(w, (const char *)src + i, run - i);
+        if (run == len) break;
+
+        unsigned char c = src[run];
+        char esc = json_escape_table[c];
+        char *p = json_writer_reserve(w, 6);
+        char *start = p;
+        *p++ = '\\';
+        if (esc == 'u') {
+            *p++ = 'u';
+            *p++ = '0';
+            *p++ = '0';
+            *p++ = hex[c >> 4];
+            *p++ = hex[c & 0xf];
+        } else {
+            *p++ = esc;
+        }
+        w->len += (size_t)(p - start);
+        i = run + 1;
+    }
+
+    json_writer_byte(w, '"');
+    RB_GC_GUARD(str);
+}
+
+/* Indent width used by generate_pretty (matches yyjson's pretty writer) */
+#define JSON_WRITER_PRETTY_INDENT 4
+
+/* State threaded through rb_hash_foreach while writing an object */
+typedef struct {
+    json_writer_t *w;
+    int first;
+} json_hash_write_arg_t;
+
+/* Newline plus indentation for the current depth (pretty mode only) */
+static void json_writer_newline(json_writer_t *w) {
+    if (!w->pretty) return;
+    size_t n = 1 + (size_t)w->depth * JSON_WRITER_PRETTY_INDENT;
+    char *p = json_writer_reserve(w, n);
+    p[0] = '\n';
+    memset(p + 1, ' ', n - 1);
+    w->len += n;
+}
+
+static void json_writer_value(json_writer_t *w, VALUE obj);
+
+/* rb_hash_foreach callback: write one key/value pair */
+static int hash_pair_write(VALUE key, VALUE val, VALUE data) {
+    json_hash_write_arg_t *arg = (json_hash_write_arg_t *)data;
+    json_writer_t *w = arg->w;
+
+    if (!arg->first) json_writer_byte(w, ',');
+    arg->first = 0;
+    json_writer_newline(w);
+
+    /* Convert key to string */
+    VALUE key_str;
+    if (RB_TYPE_P(key, T_STRING)) {
+        key_str = key;
+    } else if (RB_TYPE_P(key, T_SYMBOL)) {
+        key_str = rb_sym2str(key);
+    } else {
+        key_str = rb_funcall(key, json_writer_id_to_s, 0);
+    }
+
+    json_writer_string(w, key_str);
+    if (w->pretty) {
+        json_writer_append(w, ": ", 2);
+    } else {
+        json_writer_byte(w, ':');
+    }
+    json_writer_value(w, val);
+
+    return ST_CONTINUE;
+}
+
+/* Write a Ruby VALUE as JSON (recursive) */
+static void json_writer_value(json_writer_t *w, VALUE obj) {
+    if (NIL_P(obj)) {
+        json_writer_append(w, "null", 4);
+        return;
+    }
+
+    if (obj == Qtrue) {
+        json_writer_append(w, "true", 4);
+        return;
+    }
+
+    if (obj == Qfalse) {
+        json_writer_append(w, "false", 5);
+        return;
+    }
+
+    if (FIXNUM_P(obj)) {
+        json_writer_long(w, FIX2LONG(obj));
+        return;
+    }
+
+    if (RB_INTEGER_TYPE_P(obj)) {
+        /* Bignum - write all digits, JSON numbers have no size limit */
+        VALUE digits = rb_big2str(obj, 10);
+        json_writer_append(w, RSTRING_PTR(digits), RSTRING_LEN(digits));
+        return;
+    }
+
+    if (RB_FLOAT_TYPE_P(obj)) {
+        json_writer_double(w, RFLOAT_VALUE(obj));
+        return;
+    }
+
+    if (RB_TYPE_P(obj, T_STRING)) {
+        json_writer_string(w, obj);
+        return;
+    }
+
+    if (RB_TYPE_P(obj, T_SYMBOL)) {
+        json_writer_string(w, rb_sym2str(obj));
+        return;
+    }
+
+    if (RB_TYPE_P(obj, T_ARRAY)) {
+        long len = RARRAY_LEN(obj);
+        json_writer_byte(w, '[');
+        if (len == 0) {
+            json_writer_byte(w, ']');
+            return;
+        }
+        w->depth++;
+        for (long i = 0; i < RARRAY_LEN(obj); i++) {
+            if (i > 0) json_writer_byte(w, ',');
+            json_writer_newline(w);
+            json_writer_value(w, RARRAY_AREF(obj, i));
+        }
+        w->depth--;
+        json_writer_newline(w);
+        json_writer_byte(w, ']');
+        return;
+    }
+
+    if (RB_TYPE_P(obj, T_HASH)) {
+        json_writer_byte(w, '{');
+        if (RHASH_SIZE(obj) == 0) {
+            json_writer_byte(w, '}');
+            return;
+        }
+        json_hash_write_arg_t arg;
+        arg.w = w;
+        arg.first = 1;
+        w->depth++;
+        rb_hash_foreach(obj, hash_pair_write, (VALUE)&arg);
+        w->depth--;
+        json_writer_newline(w);
+        json_writer_byte(w, '}');
+        return;
+    }
+
+    /* For other objects, try to_json or to_s */
+    if (rb_respond_to(obj, json_writer_id_to_json)) {
+        VALUE json_str = rb_funcall(obj, json_writer_id_to_json, 0);
+        if (RB_TYPE_P(json_str, T_STRING)) {
+            const char *str = RSTRING_PTR(json_str);
+            size_t len = RSTRING_LEN(json_str);
+            /* Validate, then embed the output as raw JSON */
+            yyjson_doc *inner_doc = yyjson_read(str, len, 0);
+            if (inner_doc) {
+                yyjson_doc_free(inner_doc);
+                json_writer_append(w, str, len);
+                return;
+            }
+        }
+    }
+
+    /* Fallback: convert to string */
+    json_writer_string(w, rb_funcall(obj, json_writer_id_to_s, 0));
+}
+
+#endif /* KONPEITO_JSON_WRITER_H */
@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 yyjson_doc *konpeito_yyjson_read(const char *dat, size_t len, yyjson_read_flag flg) {
     return yyjson_read(dat, len, flg);
@@ -58,3 +59,51 @@ size_t konpeito_yyjson_arr_size(yyjson_val *arr) {
 yyjson_val *konpeito_yyjson_arr_get(yyjson_val *arr, size_t idx) {
     return yyjson_arr_get(arr, idx);
 }
+
+/*
+ * Field dispatch for parse_as / parse_array_as.
+ *
+ * The code generator builds a perfect hash over a NativeClass's field names
+ * at compile time and emits it as constant tables:
+ *   slots   - (mask + 1) entries, field index for each hash slot or -1
+ *   names   - all field names, each NUL-terminated, concatenated
+ *   offsets - nfields + 1 entries, start of each name in `names`
+ *
+ * konpeito_yyjson_obj_collect walks the object's members once, hashes each
+ * key, confirms the candidate with a length check and memcmp, and stores the
+ * value in out[field]. Unknown keys are skipped. For duplicate keys the first
+ * occurrence wins, matching yyjson_obj_get. The hash must stay in sync with
+ * json_field_hash in llvm_generator.rb.
+ */
+static inline uint32_t konpeito_field_hash(const char *key, size_t len, uint32_t seed) {
+    uint32_t h = 0x811C9DC5u ^ seed;
+    h = (h ^ (uint32_t)len) * 0x01000193u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (uint8_t)key[i]) * 0x01000193u;
+    }
+    return h ^ (h >> 16);
+}
+
+void konpeito_yyjson_obj_collect(yyjson_val *obj, uint32_t seed, uint32_t mask,
+                                 const int32_t *slots, const char *names,
+                                 const uint32_t *offsets, uint32_t nfields,
+                                 yyjson_val **out) {
+    yyjson_obj_iter iter;
+    yyjson_val *key;
+
+    memset(out, 0, sizeof(yyjson_val *) * nfields);
+    if (!yyjson_obj_iter_init(obj, &iter)) return;
+
+    while ((key = yyjson_obj_iter_next(&iter))) {
+        const char *str = unsafe_yyjson_get_str(key);
+        size_t len = unsafe_yyjson_get_len(key);
+        int32_t field = slots[konpeito_field_hash(str, len, seed) & mask];
+
+        if (field < 0) continue;
+        if (offsets[field + 1] - offsets[field] - 1 != len) continue;
+        if (memcmp(names + offsets[field], str, len) != 0) continue;
+        if (out[field]) continue;
+
+        out[field] = yyjson_obj_iter_get_val(key);
+    }
+}
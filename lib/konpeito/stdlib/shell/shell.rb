@@ -17,4 +17,7 @@ module KonpeitoShell
   def self.write_file(path, content) end
   def self.append_file(path, content) end
   def self.file_exists(path) end
+  def self.mmap_file(path) end
+  def self.unmap_file(data) end
+  def self.each_line(path) end
 end
@@ -6,13 +6,19 @@
  *
  * All functions use scalar types (const char*, int) for @cfunc compatibility.
  * Returned strings use a dynamically allocated global buffer that is reused
- * across calls (caller must use result before next call).
+ * across calls (caller must use result before next call). mmap_file is the
+ * exception: it returns a ByteSlice view that stays valid until unmap_file.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /* ═══════════════════════════════════════════
  *  Shell Execution (popen)
@@ -193,3 +199,89 @@ int konpeito_shell_file_exists(const char *path) {
     }
     return 0;
 }
+
+/* ═══════════════════════════════════════════
+ *  Memory-mapped files
+ * ═══════════════════════════════════════════ */
+
+/*
+ * Live mappings, so unmap_file only ever munmaps memory that mmap_file
+ * handed out (a ByteSlice may just as well point into a ByteBuffer).
+ */
+typedef struct {
+    void *addr;
+    size_t len;
+} shell_mapping_t;
+
+static shell_mapping_t *g_mappings = NULL;
+static size_t g_mapping_count = 0;
+static size_t g_mapping_capacity = 0;
+
+static int shell_mapping_add(void *addr, size_t len) {
+    if (g_mapping_count == g_mapping_capacity) {
+        size_t capacity = g_mapping_capacity ? g_mapping_capacity * 2 : 8;
+        shell_mapping_t *grown = (shell_mapping_t *)realloc(g_mappings, capacity * sizeof(shell_mapping_t));
+        if (!grown) return -1;
+        g_mappings = grown;
+        g_mapping_capacity = capacity;
+    }
+    g_mappings[g_mapping_count].addr = addr;
+    g_mappings[g_mapping_count].len = len;
+    g_mapping_count++;
+    return 0;
+}
+
+/*
+ * Map a file read-only and return a pointer to its contents, storing the
+ * size in *out_len (bound as a ByteSlice result, so nothing is copied and
+ * binary data is not truncated). The kernel is told the mapping will be
+ * read sequentially. Returns an empty slice if the file cannot be opened
+ * or mapped, or is empty. The view stays valid until unmap_file.
+ */
+const char *konpeito_shell_mmap_file(const char *path, int64_t *out_len) {
+    *out_len = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return "";
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        close(fd);
+        return "";
+    }
+
+    size_t len = (size_t)st.st_size;
+    void *addr = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  /* the mapping keeps its own reference to the file */
+    if (addr == MAP_FAILED) return "";
+
+#ifdef MADV_SEQUENTIAL
+    madvise(addr, len, MADV_SEQUENTIAL);
+#endif
+
+    if (shell_mapping_add(addr, len) != 0) {
+        munmap(addr, len);
+        return "";
+    }
+
+    *out_len = (int64_t)len;
+    return (const char *)addr;
+}
+
+/*
+ * Release a view returned by mmap_file. The slice must be the one
+ * mmap_file returned (not a sub-slice). Returns 0 on success, -1 if it
+ * is not a live mapping. Empty slices are accepted and ignored.
+ */
+int konpeito_shell_unmap_file(const void *data, int64_t len) {
+    if (len == 0) return 0;
+
+    for (size_t i = 0; i < g_mapping_count; i++) {
+        if (g_mappings[i].addr == data && g_mappings[i].len == (size_t)len) {
+            munmap(g_mappings[i].addr, g_mappings[i].len);
+            g_mappings[i] = g_mappings[--g_mapping_count];
+            return 0;
+        }
+    }
+    return -1;
+}
@@ -25,10 +25,16 @@ module Konpeito
           { type: :simd }
         when /\Affi:\s*"([^"]+)"\z/
           { type: :ffi, library: ::Regexp.last_match(1) }
+        when /\Acfunc:\s*"([^"]+)"\s+returns:\s*"([^"]+)"\z/
+          { type: :cfunc, c_name: ::Regexp.last_match(1), returns: ::Regexp.last_match(2).to_sym }
         when /\Acfunc:\s*"([^"]+)"\z/
           { type: :cfunc, c_name: ::Regexp.last_match(1) }
+        when /\Acfunc\s+returns:\s*"([^"]+)"\z/
+          { type: :cfunc, returns: ::Regexp.last_match(1).to_sym }
         when /\Acfunc\z/
           { type: :cfunc }
+        when /\Anogvl\z/
+          { type: :nogvl }
         when /\Ajvm_static:\s*"([^"]+)"\z/
           { type: :jvm_static, java_class: ::Regexp.last_match(1) }
         when /\Acallback:\s*"([^"]+)"\s+descriptor:\s*"([^"]+)"\z/
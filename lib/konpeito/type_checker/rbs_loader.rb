@@ -1368,7 +1368,22 @@ module Konpeito
 
         return_type = parse_cfunc_type(rbs_type_to_string(func_type.return_type))
 
-        cfunc_type = Types::CFuncType.new(c_func_name, param_types, return_type)
+        return_convention = cfunc_ann[:returns] || :cstr
+        unless Types::CFuncType::RETURN_CONVENTIONS.include?(return_convention)
+          warn "Warning: %a{cfunc} #{context_name}.#{member.name} has unknown returns: \"#{return_convention}\", using \"cstr\""
+          return_convention = :cstr
+        end
+        if return_convention == :ptr_len && !%i[String ByteSlice].include?(return_type)
+          warn "Warning: %a{cfunc} #{context_name}.#{member.name} uses returns: \"ptr_len\" but does not return String or ByteSlice"
+        end
+
+        nogvl = AnnotationParser.has?(AnnotationParser.parse_all(member.annotations), :nogvl)
+        cfunc_type = Types::CFuncType.new(c_func_name, param_types, return_type,
+                                          return_convention: return_convention, nogvl: nogvl)
+        if nogvl && !(unsafe = cfunc_type.gvl_unsafe_types).empty?
+          raise Error, "%a{nogvl} #{context_name}.#{member.name} cannot be called without the GVL: " \
+                       "#{unsafe.join(", ")} is not GVL-safe (use Float, Integer, Bool, ByteBuffer, ByteSlice, Slice or NativeArray)"
+        end
         singleton = member.kind == :singleton
         key = singleton ? :"#{context_name}.#{member.name}" : :"#{context_name}##{member.name}"
         @cfunc_methods[key] = cfunc_type
@@ -1503,6 +1518,10 @@ module Konpeito
         when "String" then :String
         when "Bool", "bool" then :Bool
         when "void", "nil" then :void
+        when "ByteBuffer" then :ByteBuffer
+        when "ByteSlice" then :ByteSlice
+        when /\A(Slice|NativeArray)\[\s*(\w+)\s*\]\z/
+          TypeChecker::Types::CFuncType.buffer_param_type(Regexp.last_match(1), Regexp.last_match(2))
         else type_str.to_sym
         end
       end
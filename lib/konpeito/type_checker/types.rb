@@ -1046,7 +1046,7 @@ module Konpeito
       #   # @cfunc "fast_sin" : (Float) -> Float
       #   def self.sin: (Float) -> Float
       class CFuncType
-        attr_reader :c_func_name, :param_types, :return_type
+        attr_reader :c_func_name, :param_types, :return_type, :return_convention, :nogvl
 
         # Type mappings from RBS to C/LLVM types
         C_TYPE_MAP = {
@@ -1054,16 +1054,78 @@ module Konpeito
           Integer: :int64,
           String: :ptr,
           Bool: :i1,
+          ByteSlice: :ptr,
           void: :void
         }.freeze
 
+        # Native buffer parameters are passed without copying as two C
+        # arguments: the data pointer and its length (bytes for ByteBuffer /
+        # ByteSlice, elements for Slice[T] / NativeArray[T]). Slice and
+        # NativeArray keep their element type, e.g. :"Slice[Float64]".
+        BUFFER_PARAM_TYPES = %i[ByteBuffer ByteSlice Slice NativeArray].freeze
+        TYPED_BUFFER_PARAM = /\A(Slice|NativeArray)\[(\w+)\]\z/
+
+        # Return conventions for String results:
+        #   :cstr    - NUL-terminated const char* (strlen)
+        #   :ptr_len - const char* plus a trailing int64_t *out_len argument
+        # A ByteSlice result always uses :ptr_len and is not copied.
+        RETURN_CONVENTIONS = %i[cstr ptr_len].freeze
+
+        # Parameter types that can be marshalled before the GVL is released:
+        # unboxed numerics and native buffers, which the GC never moves or
+        # frees. Ruby objects (String, VALUE) are not allowed for %a{nogvl}.
+        NOGVL_PARAM_TYPES = (%i[Float Integer Bool] + BUFFER_PARAM_TYPES).freeze
+        NOGVL_RETURN_TYPES = %i[Float Integer Bool String ByteSlice void].freeze
+
         # @param c_func_name [String] The C function name to call
         # @param param_types [Array<Symbol>] Parameter types (:Float, :Integer, etc.)
         # @param return_type [Symbol] Return type
-        def initialize(c_func_name, param_types, return_type)
+        # @param return_convention [Symbol] How a String result is returned
+        # @param nogvl [Boolean] Call without holding the GVL (%a{nogvl})
+        def initialize(c_func_name, param_types, return_type, return_convention: :cstr, nogvl: false)
           @c_func_name = c_func_name
           @param_types = param_types
           @return_type = return_type
+          @return_convention = return_convention
+          @nogvl = nogvl
+        end
+
+        def self.buffer_param?(type_sym)
+          BUFFER_PARAM_TYPES.include?(type_sym) || TYPED_BUFFER_PARAM.match?(type_sym.to_s)
+        end
+
+        # Parameter type for Slice[T] / NativeArray[T]; Integer and Float
+        # elements are the Int64 and Float64 the buffers store
+        def self.buffer_param_type(kind, element)
+          element = { "Integer" => "Int64", "Float" => "Float64" }.fetch(element, element)
+          :"#{kind}[#{element}]"
+        end
+
+        # Buffer kind of a parameter type (:Slice for :"Slice[Int64]")
+        def self.buffer_kind(type_sym)
+          m = TYPED_BUFFER_PARAM.match(type_sym.to_s)
+          m ? m[1].to_sym : type_sym
+        end
+
+        # Element type of a Slice[T] / NativeArray[T] parameter, or nil
+        def self.buffer_element_type(type_sym)
+          m = TYPED_BUFFER_PARAM.match(type_sym.to_s)
+          m && m[2].to_sym
+        end
+
+        # Parameter and return types that prevent calling without the GVL
+        # @return [Array<Symbol>] Offending types (empty if GVL-safe)
+        def gvl_unsafe_types
+          unsafe = param_types.reject { |t| NOGVL_PARAM_TYPES.include?(t) || CFuncType.buffer_param?(t) }
+          unsafe << return_type unless NOGVL_RETURN_TYPES.include?(return_type)
+          unsafe.uniq
+        end
+
+        # True if the result is returned as (ptr, len)
+        def ptr_len_return?
+          return true if return_type == :ByteSlice
+
+          return_type == :String && return_convention == :ptr_len
         end
 
         def ==(other)
@@ -1071,19 +1133,25 @@ module Konpeito
 
           c_func_name == other.c_func_name &&
             param_types == other.param_types &&
-            return_type == other.return_type
+            return_type == other.return_type &&
+            return_convention == other.return_convention &&
+            nogvl == other.nogvl
         end
 
         def hash
-          [c_func_name, param_types, return_type].hash
+          [c_func_name, param_types, return_type, return_convention, nogvl].hash
         end
 
         def to_s
-          "CFuncType(#{c_func_name}: (#{param_types.join(", ")}) -> #{return_type})"
+          ret = ptr_len_return? ? "#{return_type}(ptr, len)" : return_type
+          "CFuncType(#{c_func_name}: (#{param_types.join(", ")}) -> #{ret})"
         end
 
         def llvm_param_types
-          param_types.map { |t| C_TYPE_MAP[t] || :value }
+          types = param_types.flat_map do |t|
+            CFuncType.buffer_param?(t) ? %i[ptr int64] : [C_TYPE_MAP[t] || :value]
+          end
+          ptr_len_return? ? types + [:ptr] : types
         end
 
         def llvm_return_type
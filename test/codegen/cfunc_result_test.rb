@@ -0,0 +1,171 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "tempfile"
+require "fileutils"
+
+# %a{cfunc} Float/Integer results are kept unboxed (:double / :i64) and
+# boxed only where they escape to Ruby.
+class CfuncResultTest < Minitest::Test
+  MATHLIB_RBS = <<~RBS
+    %a{ffi: "libm"}
+    module MathLib
+      %a{cfunc: "sqrt"}
+      def self.square_root: (Float) -> Float
+
+      %a{cfunc}
+      def self.fabs: (Float) -> Float
+
+      %a{cfunc: "labs"}
+      def self.abs_int: (Integer) -> Integer
+    end
+  RBS
+
+  MATHLIB_SOURCE = <<~RUBY
+    module MathLib
+      def self.square_root(x) = nil
+      def self.fabs(x) = nil
+      def self.abs_int(x) = nil
+    end
+  RUBY
+
+  def setup
+    @tmp_dir = Dir.mktmpdir
+    @test_count = 0
+  end
+
+  def teardown
+    FileUtils.rm_rf(@tmp_dir)
+  end
+
+  def compile_and_run(source, rbs_source, call_expr)
+    @test_count += 1
+    source_path = File.join(@tmp_dir, "test#{@test_count}.rb")
+    rbs_path = File.join(@tmp_dir, "test#{@test_count}.rbs")
+    output_path = File.join(@tmp_dir, "test#{@test_count}#{SHARED_EXT}")
+
+    File.write(source_path, MATHLIB_SOURCE + source)
+    File.write(rbs_path, MATHLIB_RBS + rbs_source)
+
+    compiler = Konpeito::Compiler.new(
+      source_file: source_path,
+      output_file: output_path,
+      rbs_paths: [rbs_path],
+      verbose: ENV["VERBOSE"] == "1"
+    )
+
+    success = compiler.compile
+
+    unless success
+      skip "Compilation failed"
+      return nil
+    end
+
+    if File.exist?(output_path)
+      require output_path
+      eval(call_expr)
+    end
+  end
+
+  def test_result_feeds_arithmetic
+    source = <<~RUBY
+      def cfunc_scaled(x)
+        MathLib.square_root(x) * 2.0 + 1.0
+      end
+
+      def cfunc_int_sum(n)
+        MathLib.abs_int(n) + 10
+      end
+    RUBY
+
+    rbs = <<~RBS
+      module TopLevel
+        def cfunc_scaled: (Float x) -> Float
+        def cfunc_int_sum: (Integer n) -> Integer
+      end
+    RBS
+
+    assert_equal 9.0, compile_and_run(source, rbs, "cfunc_scaled(16.0)")
+    assert_equal 17, cfunc_int_sum(-7)
+  end
+
+  def test_result_passed_to_another_cfunc
+    source = <<~RUBY
+      def cfunc_nested(x)
+        MathLib.square_root(MathLib.fabs(x))
+      end
+    RUBY
+
+    rbs = <<~RBS
+      module TopLevel
+        def cfunc_nested: (Float x) -> Float
+      end
+    RBS
+
+    assert_equal 5.0, compile_and_run(source, rbs, "cfunc_nested(-25.0)")
+  end
+
+  def test_result_returned_to_ruby_is_boxed
+    source = <<~RUBY
+      def cfunc_float_result(x)
+        MathLib.fabs(x)
+      end
+
+      def cfunc_int_result(n)
+        MathLib.abs_int(n)
+      end
+
+      def cfunc_results_in_array(x, n)
+        [MathLib.fabs(x), MathLib.abs_int(n)]
+      end
+    RUBY
+
+    rbs = <<~RBS
+      module TopLevel
+        def cfunc_float_result: (Float x) -> Float
+        def cfunc_int_result: (Integer n) -> Integer
+        def cfunc_results_in_array: (Float x, Integer n) -> Array[untyped]
+      end
+    RBS
+
+    result = compile_and_run(source, rbs, "cfunc_float_result(-1.5)")
+    assert_kind_of Float, result
+    assert_equal 1.5, result
+
+    result = cfunc_int_result(-(2**40))
+    assert_kind_of Integer, result
+    assert_equal 2**40, result
+
+    assert_equal [2.5, 3], cfunc_results_in_array(-2.5, -3)
+  end
+
+  def test_result_through_phi_with_boxed_value
+    source = <<~RUBY
+      def cfunc_or_nil(x, flag)
+        v = if flag
+          MathLib.square_root(x)
+        else
+          nil
+        end
+        v
+      end
+
+      def cfunc_or_element(n, values)
+        v = n > 0 ? MathLib.abs_int(n) : values[0]
+        v
+      end
+    RUBY
+
+    rbs = <<~RBS
+      module TopLevel
+        def cfunc_or_nil: (Float x, bool flag) -> Float?
+        def cfunc_or_element: (Integer n, Array[untyped] values) -> untyped
+      end
+    RBS
+
+    assert_equal 3.0, compile_and_run(source, rbs, "cfunc_or_nil(9.0, true)")
+    assert_nil cfunc_or_nil(9.0, false)
+    assert_equal 4, cfunc_or_element(4, [:unused])
+    assert_equal "boxed", cfunc_or_element(-4, ["boxed"])
+  end
+end
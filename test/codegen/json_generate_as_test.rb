@@ -0,0 +1,142 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "tempfile"
+require "fileutils"
+
+class JSONGenerateAsTest < Minitest::Test
+  YYJSON_AVAILABLE = File.exist?(File.expand_path("../../vendor/yyjson/yyjson.c", __dir__))
+
+  def setup
+    skip "yyjson source not available" unless YYJSON_AVAILABLE
+    @tmp_dir = Dir.mktmpdir
+    @test_count = 0
+  end
+
+  def teardown
+    FileUtils.rm_rf(@tmp_dir)
+  end
+
+  def compile_and_run(source, rbs_source, call_expr)
+    @test_count += 1
+    source_path = File.join(@tmp_dir, "test#{@test_count}.rb")
+    rbs_path = File.join(@tmp_dir, "test#{@test_count}.rbs")
+    output_path = File.join(@tmp_dir, "test#{@test_count}#{SHARED_EXT}")
+
+    File.write(source_path, source)
+    File.write(rbs_path, rbs_source)
+
+    compiler = Konpeito::Compiler.new(
+      source_file: source_path,
+      output_file: output_path,
+      rbs_paths: [rbs_path],
+      verbose: ENV["VERBOSE"] == "1"
+    )
+
+    success = compiler.compile
+
+    unless success
+      skip "Compilation failed"
+      return nil
+    end
+
+    if File.exist?(output_path)
+      require output_path
+      eval(call_expr)
+    end
+  end
+
+  def test_generate_as_roundtrip
+    source = <<~RUBY
+      def roundtrip(json)
+        u = KonpeitoJSON.parse_as(json, User)
+        KonpeitoJSON.generate_as(u)
+      end
+    RUBY
+
+    rbs = <<~RBS
+      class User
+        @id: Integer
+        @name: String
+        @score: Float
+
+        def self.new: () -> User
+        def id: () -> Integer
+        def name: () -> String
+        def score: () -> Float
+      end
+
+      module KonpeitoJSON
+        def self.parse_as: [T] (String json, Class[T] target_class) -> T
+      end
+
+      module TopLevel
+        def roundtrip: (String json) -> String
+      end
+    RBS
+
+    result = compile_and_run(source, rbs, 'roundtrip(\'{"score": 95.5, "name": "A\\\\"l", "id": 42}\')')
+    assert_equal '{"id":42,"name":"A\\"l","score":95.5}', result
+  end
+
+  def test_generate_array_as_roundtrip
+    source = <<~RUBY
+      def roundtrip_all(json)
+        points = KonpeitoJSON.parse_array_as(json, Point)
+        KonpeitoJSON.generate_array_as(points)
+      end
+    RUBY
+
+    rbs = <<~RBS
+      class Point
+        @x: Integer
+        @y: Integer
+
+        def self.new: () -> Point
+        def x: () -> Integer
+        def y: () -> Integer
+      end
+
+      module KonpeitoJSON
+        def self.parse_array_as: [T] (String json, Class[T] element_class) -> NativeArray[T]
+      end
+
+      module TopLevel
+        def roundtrip_all: (String json) -> String
+      end
+    RBS
+
+    result = compile_and_run(source, rbs, 'roundtrip_all(\'[{"x": 1, "y": 2}, {"y": 4}]\')')
+    assert_equal '[{"x":1,"y":2},{"x":0,"y":4}]', result
+  end
+
+  def test_generate_as_rejects_unsupported_field_type
+    source = <<~RUBY
+      def encode_tagged(json)
+        KonpeitoJSON.generate_as(KonpeitoJSON.parse_as(json, Tagged))
+      end
+    RUBY
+
+    rbs = <<~RBS
+      class Tagged
+        @id: Integer
+        @kind: Symbol
+
+        def self.new: () -> Tagged
+        def id: () -> Integer
+        def kind: () -> Symbol
+      end
+
+      module KonpeitoJSON
+        def self.parse_as: [T] (String json, Class[T] target_class) -> T
+      end
+
+      module TopLevel
+        def encode_tagged: (String json) -> String
+      end
+    RBS
+
+    error = assert_raises(RuntimeError) { compile_and_run(source, rbs, "encode_tagged('{}')") }
+    assert_match(/Tagged#kind .* cannot be encoded as JSON/, error.message)
+  end
+end
@@ -175,4 +175,58 @@ class JSONParseAsTest < Minitest::Test
 
     # Note: For false case, need separate compile since method is already defined
   end
+
+  # Fields are found through a compile-time perfect hash over the key names
+  WIDE_FIELDS = (0...24).map { |i| "field_#{i}" }
+
+  def wide_schema_sources
+    source = <<~RUBY
+      def wide_checksum(json)
+        w = KonpeitoJSON.parse_as(json, Wide)
+        #{WIDE_FIELDS.each_with_index.map { |f, i| "w.#{f} * #{i + 1}" }.join(" + ")}
+      end
+    RUBY
+
+    rbs = <<~RBS
+      class Wide
+      #{WIDE_FIELDS.map { |f| "  @#{f}: Integer" }.join("\n")}
+
+        def self.new: () -> Wide
+      #{WIDE_FIELDS.map { |f| "  def #{f}: () -> Integer" }.join("\n")}
+      end
+
+      module KonpeitoJSON
+        def self.parse_as: [T] (String json, Class[T] target_class) -> T
+      end
+
+      module TopLevel
+        def wide_checksum: (String json) -> Integer
+      end
+    RBS
+
+    [source, rbs]
+  end
+
+  def wide_checksum_of(values)
+    WIDE_FIELDS.each_with_index.sum { |f, i| values.fetch(f, 0) * (i + 1) }
+  end
+
+  def test_parse_as_wide_schema_hash_dispatch
+    source, rbs = wide_schema_sources
+    values = WIDE_FIELDS.each_with_index.to_h { |f, i| [f, (i * 37) % 101] }
+    json = "{" + values.to_a.shuffle(random: Random.new(5)).map { |k, v| %("#{k}": #{v}) }.join(", ") + "}"
+
+    assert_equal wide_checksum_of(values), compile_and_run(source, rbs, "wide_checksum(#{json.dump})")
+
+    # Unknown keys, including near misses of field names, are skipped
+    noisy = %({"field_": 1, "field_24": 2, "field_1x": 3, "Field_1": 4, "field_1": 5, "other": {"field_2": 6}})
+    assert_equal wide_checksum_of("field_1" => 5), wide_checksum(noisy)
+
+    # Duplicate keys: the first occurrence wins
+    assert_equal wide_checksum_of("field_3" => 7), wide_checksum(%({"field_3": 7, "field_3": 9}))
+
+    # Missing fields stay zero
+    assert_equal wide_checksum_of("field_23" => 2), wide_checksum(%({"field_23": 2}))
+    assert_equal 0, wide_checksum("{}")
+  end
 end
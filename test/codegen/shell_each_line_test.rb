@@ -0,0 +1,114 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "tempfile"
+require "fileutils"
+
+# KonpeitoShell.each_line is compiled inline; the file mapping must be
+# released however the block exits.
+class ShellEachLineTest < Minitest::Test
+  RBS = <<~RBS
+    module TopLevel
+      def count_lines: (String path) -> Integer
+      def find_line: (String path, Integer first) -> Integer
+      def count_until: (String path, Integer first) -> Integer
+      def count_skipping: (String path, Integer first) -> Integer
+      def raise_on: (String path, Integer first) -> Integer
+    end
+  RBS
+
+  SOURCE = <<~RUBY
+    def count_lines(path)
+      n = 0
+      KonpeitoShell.each_line(path) { |line| n = n + 1 }
+      n
+    end
+
+    def find_line(path, first)
+      n = 0
+      KonpeitoShell.each_line(path) do |line|
+        n = n + 1
+        return n if line.length > 0 && line[0] == first
+      end
+      -1
+    end
+
+    def count_until(path, first)
+      n = 0
+      KonpeitoShell.each_line(path) do |line|
+        break if line.length > 0 && line[0] == first
+        n = n + 1
+      end
+      n
+    end
+
+    def count_skipping(path, first)
+      n = 0
+      KonpeitoShell.each_line(path) do |line|
+        next if line.length > 0 && line[0] == first
+        n = n + 1
+      end
+      n
+    end
+
+    def raise_on(path, first)
+      KonpeitoShell.each_line(path) do |line|
+        raise ArgumentError, "found" if line.length > 0 && line[0] == first
+      end
+      0
+    end
+  RUBY
+
+  def setup
+    @tmp_dir = Dir.mktmpdir
+    @data_path = File.join(@tmp_dir, "lines.txt")
+    File.write(@data_path, "alpha\nbeta\ngamma\ndelta\n")
+  end
+
+  def teardown
+    FileUtils.rm_rf(@tmp_dir)
+  end
+
+  def compile_and_load
+    source_path = File.join(@tmp_dir, "each_line.rb")
+    rbs_path = File.join(@tmp_dir, "each_line.rbs")
+    output_path = File.join(@tmp_dir, "each_line#{SHARED_EXT}")
+
+    File.write(source_path, SOURCE)
+    File.write(rbs_path, RBS)
+
+    compiler = Konpeito::Compiler.new(
+      source_file: source_path,
+      output_file: output_path,
+      rbs_paths: [rbs_path],
+      verbose: ENV["VERBOSE"] == "1"
+    )
+
+    skip "Compilation failed" unless compiler.compile
+    require output_path
+  end
+
+  # Mappings of the data file still live in this process (Linux only)
+  def live_mappings
+    return 0 unless File.exist?("/proc/self/maps")
+
+    File.readlines("/proc/self/maps").count { |l| l.include?(@data_path) }
+  end
+
+  def test_early_exits_release_mapping
+    compile_and_load
+    before = live_mappings
+
+    assert_equal 4, count_lines(@data_path)
+    assert_equal 3, find_line(@data_path, "g".ord)
+    assert_equal(-1, find_line(@data_path, "z".ord))
+    assert_equal 2, count_until(@data_path, "g".ord)
+    assert_equal 3, count_skipping(@data_path, "b".ord)
+
+    error = assert_raises(ArgumentError) { raise_on(@data_path, "d".ord) }
+    assert_equal "found", error.message
+    assert_equal 0, raise_on(@data_path, "z".ord)
+
+    assert_equal before, live_mappings
+  end
+end
@@ -126,4 +126,51 @@ class HIRBuilderTest < Minitest::Test
 
     assert_instance_of Konpeito::HIR::Return, entry.terminator
   end
+
+  def test_shell_each_line_binds_byte_slice_param
+    shell_rbs = File.expand_path("../../lib/konpeito/stdlib/shell/shell.rbs", __dir__)
+    loader = Konpeito::TypeChecker::RBSLoader.new.load(rbs_paths: [shell_rbs])
+    ast = Konpeito::Parser::PrismAdapter.parse(<<~RUBY)
+      def total(path)
+        n = 0
+        KonpeitoShell.each_line(path) { |line| n = n + line.length }
+        n
+      end
+    RUBY
+    typed_ast = Konpeito::AST::TypedASTBuilder.new(loader).build(ast)
+    program = Konpeito::HIR::Builder.new(rbs_loader: loader).build(typed_ast)
+
+    total = program.functions.find { |f| f.name == "total" }
+    call = total.body.flat_map(&:instructions).find { |i| i.is_a?(Konpeito::HIR::Call) && i.method_name == "each_line" }
+    refute_nil call
+    assert_equal ["line"], call.block.params.map(&:name)
+    assert_equal Konpeito::TypeChecker::Types::BYTESLICE, call.block.params.first.type
+
+    body = call.block.body.flat_map(&:instructions)
+    assert body.any? { |i| i.is_a?(Konpeito::HIR::ByteSliceLength) }
+  end
+
+  def test_shell_each_line_break_and_next_jump_to_block_labels
+    shell_rbs = File.expand_path("../../lib/konpeito/stdlib/shell/shell.rbs", __dir__)
+    loader = Konpeito::TypeChecker::RBSLoader.new.load(rbs_paths: [shell_rbs])
+    ast = Konpeito::Parser::PrismAdapter.parse(<<~RUBY)
+      def scan(path)
+        KonpeitoShell.each_line(path) do |line|
+          next if line.length == 0
+          break if line.length > 80
+        end
+      end
+    RUBY
+    typed_ast = Konpeito::AST::TypedASTBuilder.new(loader).build(ast)
+    program = Konpeito::HIR::Builder.new(rbs_loader: loader).build(typed_ast)
+
+    scan = program.functions.find { |f| f.name == "scan" }
+    call = scan.body.flat_map(&:instructions).find { |i| i.is_a?(Konpeito::HIR::Call) && i.method_name == "each_line" }
+    refute_nil call.block.next_label
+    refute_nil call.block.break_label
+
+    targets = call.block.body.map(&:terminator).grep(Konpeito::HIR::Jump).map(&:target)
+    assert_includes targets, call.block.next_label
+    assert_includes targets, call.block.break_label
+  end
 end
@@ -2,6 +2,8 @@
 
 require 'minitest/autorun'
 require 'zlib'
+require 'stringio'
+require 'tmpdir'
 
 # Build the extension first (skip if native build fails, e.g. missing zlib-dev on CI)
 COMPRESSION_NATIVE_AVAILABLE = begin
@@ -150,10 +152,215 @@ class KonpeitoCompressionTest < Minitest::Test
     end
   end
 
+  def test_error_on_truncated_gzip_data
+    compressed = KonpeitoCompression.gzip(Random.new(5).bytes(100_000))
+    assert_raises(RuntimeError) { KonpeitoCompression.gunzip(compressed[0, compressed.bytesize / 2]) }
+    assert_raises(RuntimeError) { KonpeitoCompression.inflate(KonpeitoCompression.deflate("x" * 100_000, nil)[0, 20]) }
+  end
+
+  def test_large_data_from_threads
+    # Above the no-GVL threshold: each thread gets its own correct result
+    inputs = 4.times.map { |i| (TEST_DATA + i.to_s) * 2_000 }
+    threads = inputs.map do |input|
+      Thread.new { KonpeitoCompression.gunzip(KonpeitoCompression.gzip(input)) }
+    end
+    threads.zip(inputs).each { |t, input| assert_equal input, t.value }
+  end
+
   def test_large_data
     large_data = "x" * (1024 * 1024) # 1MB of data
     compressed = KonpeitoCompression.gzip(large_data)
     decompressed = KonpeitoCompression.gunzip(compressed)
     assert_equal large_data, decompressed
   end
+
+  # Streaming gzip
+
+  def test_gzip_writer_stream_compatible_with_ruby_zlib
+    io = StringIO.new("".b)
+    writer = KonpeitoCompression::GzipWriter.new(io, level: KonpeitoCompression::BEST_SPEED)
+    100.times { |i| writer << "line #{i}\n" }
+    assert_equal 5, writer.write("tail\n")
+    writer.close
+    expected = (0...100).map { |i| "line #{i}\n" }.join + "tail\n"
+    assert_equal expected, Zlib.gunzip(io.string)
+  end
+
+  def test_gzip_writer_sink_keeps_chunks
+    sink = Class.new do
+      attr_reader :chunks
+
+      def initialize = @chunks = []
+      def write(s) = @chunks << s
+    end.new
+    data = Random.new(4).bytes(300_000)
+    writer = KonpeitoCompression::GzipWriter.new(sink, level: KonpeitoCompression::BEST_SPEED)
+    writer << data
+    writer.close
+
+    assert_operator sink.chunks.size, :>, 1
+    assert_equal sink.chunks.size, sink.chunks.map(&:object_id).uniq.size
+    assert_equal data, Zlib.gunzip(sink.chunks.join).b
+  end
+
+  def test_gzip_stream_bad_path_leaves_uninitialized
+    writer = KonpeitoCompression::GzipWriter.allocate
+    assert_raises(SystemCallError) { writer.send(:initialize, "/nonexistent/dir/out.gz") }
+    assert_raises(RuntimeError) { writer << "data" }
+    reader = KonpeitoCompression::GzipReader.allocate
+    assert_raises(SystemCallError) { reader.send(:initialize, "/nonexistent/dir/in.gz") }
+    assert_raises(RuntimeError) { reader.read }
+  end
+
+  def test_gzip_reader_rejects_non_string_chunks
+    source = Object.new
+    def source.read(_) = 42
+    reader = KonpeitoCompression::GzipReader.new(source)
+    assert_raises(TypeError) { reader.read }
+  end
+
+  def test_gzip_reader_read_in_chunks
+    data = Random.new(1).bytes(200_000) + TEST_DATA
+    reader = KonpeitoCompression::GzipReader.new(StringIO.new(Zlib.gzip(data)))
+    out = "".b
+    while (chunk = reader.read(7_000))
+      assert chunk.bytesize <= 7_000
+      out << chunk
+    end
+    assert reader.eof?
+    assert_equal data.b, out
+    assert_equal "", reader.read
+  end
+
+  def test_gzip_stream_file_roundtrip
+    Dir.mktmpdir do |dir|
+      path = File.join(dir, "data.gz")
+      writer = KonpeitoCompression::GzipWriter.new(path)
+      10.times { writer << TEST_DATA }
+      writer.close
+      assert_equal TEST_DATA * 10, Zlib.gunzip(File.binread(path))
+
+      reader = KonpeitoCompression::GzipReader.new(path)
+      chunks = reader.each_chunk.to_a
+      reader.close
+      assert_equal TEST_DATA * 10, chunks.join
+    end
+  end
+
+  def test_gzip_reader_concatenated_members
+    io = StringIO.new(Zlib.gzip("first,") + Zlib.gzip("second"))
+    reader = KonpeitoCompression::GzipReader.new(io)
+    refute reader.eof?
+    assert_equal "first,second", reader.read
+  end
+
+  def test_gzip_reader_truncated_data
+    compressed = KonpeitoCompression.gzip(TEST_DATA)
+    reader = KonpeitoCompression::GzipReader.new(StringIO.new(compressed[0, compressed.bytesize / 2]))
+    assert_raises(RuntimeError) { reader.read }
+  end
+
+  def test_gzip_stream_closed
+    writer = KonpeitoCompression::GzipWriter.new(StringIO.new("".b))
+    writer.close
+    assert_raises(IOError) { writer << "data" }
+    reader = KonpeitoCompression::GzipReader.new(StringIO.new(Zlib.gzip("x")))
+    reader.close
+    assert_raises(IOError) { reader.read }
+  end
+
+  def test_gzip_stream_usable_after_interrupted_write
+    # The pending Thread#raise fires at the no-GVL deflate call
+    writer = KonpeitoCompression::GzipWriter.new(StringIO.new("".b))
+    big = Random.new(3).bytes(100_000)
+    error = Thread.handle_interrupt(RuntimeError => :never) do
+      Thread.current.raise "interrupted"
+      Thread.handle_interrupt(RuntimeError => :on_blocking) { writer.write(big) }
+    rescue RuntimeError => e
+      e
+    end
+    assert_equal "interrupted", error.message
+    writer.write("more")
+    writer.close
+  end
+
+  # Parallel gzip
+
+  def test_gzip_parallel_compatible_with_ruby_zlib
+    data = (TEST_DATA + Random.new(2).bytes(3_000)) * 200 # ~1.6MB, many blocks
+    compressed = KonpeitoCompression.gzip_parallel(data, threads: 4)
+    assert_equal data.b, Zlib.gunzip(compressed).b
+    assert compressed.bytesize < data.bytesize
+  end
+
+  def test_gzip_parallel_levels_and_small_input
+    [KonpeitoCompression::BEST_SPEED, KonpeitoCompression::BEST_COMPRESSION].each do |level|
+      compressed = KonpeitoCompression.gzip_parallel(TEST_DATA * 100, level: level)
+      assert_equal TEST_DATA * 100, KonpeitoCompression.gunzip(compressed)
+    end
+    assert_equal "hi", Zlib.gunzip(KonpeitoCompression.gzip_parallel("hi"))
+    assert_equal "", Zlib.gunzip(KonpeitoCompression.gzip_parallel(""))
+  end
+
+  def test_gzip_parallel_invalid_arguments
+    assert_raises(ArgumentError) { KonpeitoCompression.gzip_parallel("x", level: 12) }
+    assert_raises(ArgumentError) { KonpeitoCompression.gzip_parallel("x", threads: 0) }
+  end
+
+  # zstd / lz4 (optional libraries)
+
+  def zstd_samples
+    (0...1000).map { |i| %({"id":#{i},"user":"user#{i % 37}","status":"active","tags":["cache","session"],"ts":#{1_700_000_000 + i * 7}}) }
+  end
+
+  def test_zstd_roundtrip
+    skip "built without zstd" unless KonpeitoCompression.respond_to?(:zstd_compress)
+    compressed = KonpeitoCompression.zstd_compress(TEST_DATA)
+    assert compressed.bytesize < TEST_DATA.bytesize
+    assert_equal TEST_DATA, KonpeitoCompression.zstd_decompress(compressed)
+    fast = KonpeitoCompression.zstd_compress(TEST_DATA * 50, level: -1)
+    assert_equal TEST_DATA * 50, KonpeitoCompression.zstd_decompress(fast)
+    assert_equal "", KonpeitoCompression.zstd_decompress(KonpeitoCompression.zstd_compress(""))
+  end
+
+  def test_zstd_errors
+    skip "built without zstd" unless KonpeitoCompression.respond_to?(:zstd_compress)
+    assert_raises(RuntimeError) { KonpeitoCompression.zstd_decompress("not zstd data") }
+    compressed = KonpeitoCompression.zstd_compress(Random.new(3).bytes(100_000))
+    assert_raises(RuntimeError) { KonpeitoCompression.zstd_decompress(compressed[0, 5_000]) }
+    assert_raises(RuntimeError) { KonpeitoCompression.zstd_decompress(compressed, max_size: 1_000) }
+    assert_raises(ArgumentError) { KonpeitoCompression.zstd_compress("x", level: 100) }
+  end
+
+  def test_zstd_dictionary
+    skip "built without zstd" unless KonpeitoCompression.respond_to?(:zstd_train_dictionary)
+    samples = zstd_samples
+    dict_bytes = KonpeitoCompression.zstd_train_dictionary(samples, size: 4096)
+    assert dict_bytes.bytesize <= 4096
+    dict = KonpeitoCompression::ZstdDictionary.new(dict_bytes, level: 3)
+    assert dict.id > 0
+
+    record = samples[500]
+    plain = KonpeitoCompression.zstd_compress(record)
+    with_dict = KonpeitoCompression.zstd_compress(record, dict: dict)
+    assert with_dict.bytesize < plain.bytesize
+    assert_equal record, KonpeitoCompression.zstd_decompress(with_dict, dict: dict)
+    assert_equal record, KonpeitoCompression.zstd_decompress(with_dict, dict: dict_bytes)
+    assert_raises(RuntimeError) { KonpeitoCompression.zstd_decompress(with_dict) }
+  end
+
+  def test_lz4_roundtrip
+    skip "built without lz4" unless KonpeitoCompression.respond_to?(:lz4_compress)
+    data = TEST_DATA * 500
+    [0, 9].each do |level|
+      compressed = KonpeitoCompression.lz4_compress(data, level: level)
+      assert compressed.bytesize < data.bytesize
+      assert_equal data, KonpeitoCompression.lz4_decompress(compressed)
+    end
+    assert_equal "", KonpeitoCompression.lz4_decompress(KonpeitoCompression.lz4_compress(""))
+    assert_raises(RuntimeError) { KonpeitoCompression.lz4_decompress("not lz4 data") }
+    compressed = KonpeitoCompression.lz4_compress(data)
+    assert_raises(RuntimeError) { KonpeitoCompression.lz4_decompress(compressed[0, compressed.bytesize - 10]) }
+    assert_raises(RuntimeError) { KonpeitoCompression.lz4_decompress(compressed, max_size: 100) }
+  end
 end
@@ -2,6 +2,7 @@
 
 require 'minitest/autorun'
 require 'openssl'
+require 'tmpdir'
 
 # Build the extension first (skip if native build fails, e.g. missing openssl-dev on CI)
 CRYPTO_NATIVE_AVAILABLE = begin
@@ -161,4 +162,93 @@ class KonpeitoCryptoTest < Minitest::Test
     assert_respond_to KonpeitoCrypto, :random_hex
     assert_respond_to KonpeitoCrypto, :secure_compare
   end
+
+  def test_large_inputs_from_threads
+    # Above the no-GVL threshold: results must match OpenSSL from every thread
+    data = Random.new(4).bytes(1024 * 1024)
+    key = "k" * 64
+    threads = 4.times.map do
+      Thread.new do
+        [KonpeitoCrypto.sha256(data), KonpeitoCrypto.sha512_binary(data),
+         KonpeitoCrypto.hmac_sha256(key, data), KonpeitoCrypto.hmac_sha512(key, data)]
+      end
+    end
+    expected = [OpenSSL::Digest::SHA256.hexdigest(data), OpenSSL::Digest::SHA512.digest(data),
+                OpenSSL::HMAC.hexdigest("SHA256", key, data), OpenSSL::HMAC.hexdigest("SHA512", key, data)]
+    threads.each { |t| assert_equal expected, t.value }
+  end
+
+  # Incremental digests
+
+  def test_sha256_incremental_matches_one_shot
+    digest = KonpeitoCrypto::SHA256.new
+    digest.update("hello ") << "world"
+    assert_equal KonpeitoCrypto.sha256("hello world"), digest.hexdigest
+    assert_equal KonpeitoCrypto.sha256_binary("hello world"), digest.digest
+    # digest does not finalize: more data can follow
+    digest << "!"
+    assert_equal KonpeitoCrypto.sha256("hello world!"), digest.hexdigest
+    assert_equal KonpeitoCrypto.sha256(""), digest.reset.hexdigest
+    assert_equal KonpeitoCrypto.sha512("abc"), KonpeitoCrypto::SHA512.new("abc").hexdigest
+  end
+
+  def test_sha256_large_chunks
+    data = Random.new(6).bytes(300_000)
+    digest = KonpeitoCrypto::SHA256.new
+    data.bytes.each_slice(100_000) { |slice| digest << slice.pack("C*") }
+    assert_equal OpenSSL::Digest::SHA256.hexdigest(data), digest.hexdigest
+  end
+
+  def test_sha256_usable_after_interrupted_update
+    # The pending Thread#raise fires at the no-GVL update
+    digest = KonpeitoCrypto::SHA256.new
+    error = Thread.handle_interrupt(RuntimeError => :never) do
+      Thread.current.raise "interrupted"
+      Thread.handle_interrupt(RuntimeError => :on_blocking) { digest << Random.new(8).bytes(100_000) }
+    rescue RuntimeError => e
+      e
+    end
+    assert_equal "interrupted", error.message
+    digest << "more"
+    assert_equal 64, digest.hexdigest.size
+  end
+
+  def test_sha256_file
+    Dir.mktmpdir do |dir|
+      path = File.join(dir, "data.bin")
+      data = Random.new(7).bytes(2_500_000)
+      File.binwrite(path, data)
+      assert_equal OpenSSL::Digest::SHA256.hexdigest(data), KonpeitoCrypto::SHA256.file(path).hexdigest
+      assert_equal OpenSSL::Digest::SHA512.hexdigest(data), KonpeitoCrypto::SHA512.file(path).hexdigest
+      assert_raises(Errno::ENOENT) { KonpeitoCrypto::SHA256.file(File.join(dir, "missing")) }
+    end
+  end
+
+  def test_sha256_file_holds_digest_while_reading
+    skip "needs File.mkfifo" unless File.respond_to?(:mkfifo)
+    Dir.mktmpdir do |dir|
+      path = File.join(dir, "fifo")
+      File.mkfifo(path)
+      # Opened read-write so the reader's open does not block
+      fifo = File.open(path, File::RDWR)
+      digest = KonpeitoCrypto::SHA256.new
+      reader = Thread.new { digest.file(path) }
+      sleep 0.2 # reader is now blocked in read() without the GVL
+
+      assert_raises(RuntimeError) { digest << Random.new(9).bytes(100_000) }
+      fifo.write("abc")
+      fifo.close
+      reader.join
+      assert_equal OpenSSL::Digest::SHA256.hexdigest("abc"), digest.hexdigest
+    end
+  end
+
+  def test_sha256_many
+    messages = ["", "a", "hello world"] + (0...2_000).map { |i| "key:#{i}" }
+    assert_equal messages.map { |m| KonpeitoCrypto.sha256(m) }, KonpeitoCrypto.sha256_many(messages)
+    assert_equal messages.map { |m| KonpeitoCrypto.sha256_binary(m) }, KonpeitoCrypto.sha256_many(messages, binary: true)
+    assert_equal [KonpeitoCrypto.sha512("x")], KonpeitoCrypto.sha512_many(["x"])
+    assert_equal [], KonpeitoCrypto.sha256_many([])
+    assert_raises(TypeError) { KonpeitoCrypto.sha256_many([1]) }
+  end
 end
@@ -15,6 +15,77 @@ rescue LoadError, StandardError
   false
 end
 
+require 'socket'
+require 'tmpdir'
+require 'zlib'
+
+# Minimal keep-alive HTTP/1.1 server for offline tests, run in a child
+# process so it keeps serving while a request holds the GVL. Every response
+# is a JSON echo of the request plus the id of the TCP connection it
+# arrived on, except /bytes/<n>, which returns n bytes of "abc...z" text.
+# Paths under /gzip/ are gzip-encoded when the client accepts it.
+class LocalHTTPServer
+  attr_reader :port
+
+  def initialize
+    server = TCPServer.new('127.0.0.1', 0)
+    @port = server.addr[1]
+    @pid = fork { accept_loop(server) }
+    server.close
+  end
+
+  def url(path = '/')
+    "http://127.0.0.1:#{@port}#{path}"
+  end
+
+  def close
+    Process.kill(:TERM, @pid)
+    Process.wait(@pid)
+  end
+
+  private
+
+  def accept_loop(server)
+    connections = 0
+    loop do
+      socket = server.accept
+      id = (connections += 1)
+      Thread.new { serve(socket, id) }
+    end
+  end
+
+  def serve(socket, id)
+    while (request_line = socket.gets)
+      method, path, = request_line.split(' ')
+      headers = {}
+      while (line = socket.gets) && line != "\r\n"
+        name, value = line.split(':', 2)
+        headers[name.downcase] = value.strip
+      end
+      body = socket.read(headers['content-length'].to_i) if headers['content-length']
+      status = path.start_with?('/status/') ? path.split('/').last.to_i : 200
+      sleep(path.split('/').last.to_i / 1000.0) if path.start_with?('/delay/')
+      payload = if path.start_with?('/bytes/')
+                  Array.new(path.split('/').last.to_i) { |i| (97 + i % 26).chr }.join
+                else
+                  JSON.generate('method' => method, 'path' => path, 'body' => body,
+                                'headers' => headers, 'connection' => id)
+                end
+      encoding = ''
+      if path.start_with?('/gzip/') && headers['accept-encoding'].to_s.include?('gzip')
+        payload = Zlib.gzip(payload)
+        encoding = "Content-Encoding: gzip\r\n"
+      end
+      socket.write("HTTP/1.1 #{status} OK\r\nContent-Type: application/json\r\n#{encoding}" \
+                   "Content-Length: #{payload.bytesize}\r\n\r\n#{payload}")
+    end
+  rescue IOError, SystemCallError
+    nil
+  ensure
+    socket.close
+  end
+end
+
 class KonpeitoHTTPTest < Minitest::Test
   # Use httpbin.org for testing HTTP functionality
   # These tests require network access
@@ -130,6 +201,199 @@ class KonpeitoHTTPTest < Minitest::Test
   end
 
   # Offline tests (no network required)
+
+  def with_local_server
+    server = LocalHTTPServer.new
+    yield server
+  ensure
+    server&.close
+  end
+
+  def test_client_reuses_connection
+    with_local_server do |server|
+      client = KonpeitoHTTP::Client.new
+      ids = 5.times.map do |i|
+        response = client.get(server.url("/item/#{i}"))
+        assert_equal 200, response[:status]
+        data = JSON.parse(response[:body])
+        assert_equal "/item/#{i}", data['path']
+        data['connection']
+      end
+      assert_equal [1], ids.uniq
+      client.close
+    end
+  end
+
+  def test_client_request_methods
+    with_local_server do |server|
+      client = KonpeitoHTTP::Client.new(max_per_host: 2, timeout: 5)
+      response = client.post(server.url('/post'), 'payload', {'X-Token' => 'abc'})
+      data = JSON.parse(response[:body])
+      assert_equal 'POST', data['method']
+      assert_equal 'payload', data['body']
+      assert_equal 'abc', data['headers']['x-token']
+      assert_equal 'application/json', response[:headers]['Content-Type']
+
+      response = client.request('DELETE', server.url('/status/404'))
+      assert_equal 404, response[:status]
+      assert_equal 'DELETE', JSON.parse(response[:body])['method']
+      client.close
+    end
+  end
+
+  def test_request_local
+    with_local_server do |server|
+      response = KonpeitoHTTP.request('PUT', server.url('/put'), 'x', {'X-A' => 1})
+      data = JSON.parse(response[:body])
+      assert_equal ['PUT', 'x', '1'], [data['method'], data['body'], data['headers']['x-a']]
+    end
+  end
+
+  def test_request_all
+    with_local_server do |server|
+      requests = [
+        server.url('/a'),
+        {url: server.url('/b'), method: :post, body: 'data'},
+        {url: 'http://127.0.0.1:1/refused'},
+        {url: server.url('/status/404'), method: 'PUT', headers: {'X-N' => '4'}}
+      ]
+      responses = KonpeitoHTTP.request_all(requests, concurrency: 2)
+      assert_equal 4, responses.size
+      assert_equal ['/a', 'GET'], JSON.parse(responses[0][:body]).values_at('path', 'method')
+      # Module defaults, unlike Client: no Accept-Encoding
+      assert_nil JSON.parse(responses[0][:body])['headers']['accept-encoding']
+      assert_equal ['POST', 'data'], JSON.parse(responses[1][:body]).values_at('method', 'body')
+      assert_equal 0, responses[2][:status]
+      assert_kind_of String, responses[2][:error]
+      assert_equal 404, responses[3][:status]
+      assert_equal '4', JSON.parse(responses[3][:body])['headers']['x-n']
+      assert_equal [], KonpeitoHTTP.request_all([])
+    end
+  end
+
+  def test_request_all_runs_concurrently
+    with_local_server do |server|
+      client = KonpeitoHTTP::Client.new
+      started = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      responses = client.request_all(Array.new(8) { |i| server.url("/delay/#{200 + i}") }, concurrency: 8)
+      elapsed = Process.clock_gettime(Process::CLOCK_MONOTONIC) - started
+      assert_equal (0...8).map { |i| "/delay/#{200 + i}" },
+                   responses.map { |r| JSON.parse(r[:body])['path'] }
+      assert_operator elapsed, :<, 1.0
+      client.close
+    end
+  end
+
+  def test_client_releases_gvl
+    with_local_server do |server|
+      client = KonpeitoHTTP::Client.new
+      ticks = 0
+      ticker = Thread.new { loop { ticks += 1; sleep 0.01 } }
+      client.get(server.url('/delay/300'))
+      ticker.kill
+      assert_operator ticks, :>, 5
+      client.close
+    end
+  end
+
+  def test_client_large_body
+    with_local_server do |server|
+      client = KonpeitoHTTP::Client.new
+      body = client.get(server.url('/bytes/1000000'))[:body]
+      assert_equal 1_000_000, body.bytesize
+      assert_equal 'abcd', body[0, 4]
+      assert_equal 'mn', body[-2, 2]
+      client.close
+    end
+  end
+
+  def test_client_stream
+    with_local_server do |server|
+      client = KonpeitoHTTP::Client.new
+      chunks = []
+      response = client.stream('GET', server.url('/bytes/300000')) { |chunk| chunks << chunk }
+      assert_equal 200, response[:status]
+      assert_nil response[:body]
+      assert_equal 300_000, response[:size]
+      assert_operator chunks.size, :>, 1
+      assert chunks.all? { |chunk| chunk.bytesize <= 128 * 1024 }
+      assert_equal 300_000, chunks.sum(&:bytesize)
+      assert_equal 'abc', chunks.first[0, 3]
+
+      assert_raises(ZeroDivisionError) do
+        client.stream('GET', server.url('/bytes/300000')) { |_chunk| 1 / 0 }
+      end
+      assert_equal 200, client.get(server.url('/after'))[:status]
+      client.close
+    end
+  end
+
+  def test_client_download
+    with_local_server do |server|
+      client = KonpeitoHTTP::Client.new
+      Dir.mktmpdir do |dir|
+        path = File.join(dir, 'out.txt')
+        response = client.download(server.url('/bytes/200000'), path)
+        assert_equal 200, response[:status]
+        assert_equal 200_000, response[:size]
+        assert_equal 200_000, File.size(path)
+        assert_equal 'abcde', File.read(path, 5)
+        assert_raises(Errno::ENOENT) { client.download(server.url('/bytes/1'), File.join(dir, 'no/such/file')) }
+      end
+      client.close
+    end
+  end
+
+  def test_long_and_invalid_headers
+    with_local_server do |server|
+      token = 'Bearer ' + 'x' * 4000
+      response = KonpeitoHTTP.request('GET', server.url('/h'), nil, {'Authorization' => token, :x_sym => 7})
+      data = JSON.parse(response[:body])
+      assert_equal token, data['headers']['authorization']
+      assert_equal '7', data['headers']['x_sym']
+
+      assert_raises(ArgumentError) do
+        KonpeitoHTTP.request('GET', server.url('/h'), nil, {'X-A' => "1\r\nX-Injected: 1"})
+      end
+    end
+  end
+
+  def test_response_header_names_interned
+    with_local_server do |server|
+      client = KonpeitoHTTP::Client.new
+      first = client.get(server.url('/1'))[:headers].keys
+      second = client.get(server.url('/2'))[:headers].keys
+      assert first.all?(&:frozen?)
+      assert_same first.find { |k| k == 'Content-Type' }, second.find { |k| k == 'Content-Type' }
+      client.close
+    end
+  end
+
+  def test_client_decodes_compressed_bodies
+    with_local_server do |server|
+      client = KonpeitoHTTP::Client.new
+      response = client.get(server.url('/gzip/data'))
+      assert_equal 'gzip', response[:headers]['Content-Encoding']
+      data = JSON.parse(response[:body])
+      assert_match(/gzip/, data['headers']['accept-encoding'])
+      client.close
+
+      plain = KonpeitoHTTP::Client.new(compressed: false, http2: false)
+      response = plain.get(server.url('/gzip/data'))
+      assert_nil response[:headers]['Content-Encoding']
+      assert_nil JSON.parse(response[:body])['headers']['accept-encoding']
+      plain.close
+    end
+  end
+
+  def test_client_close
+    client = KonpeitoHTTP::Client.new
+    refute client.closed?
+    client.close
+    assert client.closed?
+    assert_raises(IOError) { client.get('http://127.0.0.1:1/') }
+    assert_raises(ArgumentError) { KonpeitoHTTP::Client.new(max_per_host: 0) }
+  end
   def test_module_exists
     assert_kind_of Module, KonpeitoHTTP
   end
@@ -1,6 +1,8 @@
 # frozen_string_literal: true
 
 require "minitest/autorun"
+require "stringio"
+require "tmpdir"
 
 # Build the extension if needed (skip if native build fails on CI)
 JSON_NATIVE_AVAILABLE = begin
@@ -86,11 +88,145 @@ class KonpeitoJSONTest < Minitest::Test
     assert_raises(ArgumentError) { KonpeitoJSON.parse("[1, 2,]") } # trailing comma without flag
   end
 
+  def test_parse_keys_are_frozen_and_shared
+    json = '[{"id": 1, "name": "a"}, {"id": 2, "name": "b"}]'
+    result = KonpeitoJSON.parse(json)
+    k1 = result[0].keys
+    k2 = result[1].keys
+    assert k1.all?(&:frozen?)
+    assert_same k1[0], k2[0]
+    assert_same k1[1], k2[1]
+  end
+
+  def test_parse_long_keys
+    key = "k" * 100
+    result = KonpeitoJSON.parse(%({"#{key}": 1, "#{key}x": 2}))
+    assert_equal 1, result[key]
+    assert_equal 2, result["#{key}x"]
+  end
+
+  def test_parse_symbolize_names
+    json = '{"name": "Alice", "tags": [{"id": 1}], "nested": {"deep": true}}'
+    result = KonpeitoJSON.parse(json, symbolize_names: true)
+    assert_equal "Alice", result[:name]
+    assert_equal 1, result[:tags][0][:id]
+    assert_equal true, result[:nested][:deep]
+    assert_equal({"name" => "Alice"}, KonpeitoJSON.parse('{"name": "Alice"}', symbolize_names: false))
+  end
+
   def test_parse_type_error
     assert_raises(TypeError) { KonpeitoJSON.parse(123) }
     assert_raises(TypeError) { KonpeitoJSON.parse(nil) }
   end
 
+  def test_parse_insitu
+    json = +'{"a": [1, 2.5, "x\\ny"], "b": {"c": null}}'
+    expected = KonpeitoJSON.parse(json)
+    assert_equal expected, KonpeitoJSON.parse(json, insitu: true)
+    assert_equal "", json
+
+    json = +'{"k": 1}'
+    assert_equal({k: 1}, KonpeitoJSON.parse(json, insitu: true, symbolize_names: true))
+  end
+
+  def test_parse_insitu_errors
+    assert_raises(FrozenError) { KonpeitoJSON.parse("[1]".freeze, insitu: true) }
+    json = +"[1,"
+    assert_raises(ArgumentError) { KonpeitoJSON.parse(json, insitu: true) }
+    assert_equal "", json
+  end
+
+  def test_parse_insitu_large
+    # Above the threshold the insitu read runs without the GVL on a locked String
+    json = KonpeitoJSON.generate((0...5000).map { |i| {"id" => i} })
+    assert_operator json.bytesize, :>, 32 * 1024
+    assert_equal 5000, KonpeitoJSON.parse(json, insitu: true).size
+    assert_equal "", json
+    json << "[1]" # unlocked again
+    assert_equal [1], KonpeitoJSON.parse(json)
+
+    bad = +"[#{'1,' * 20000}"
+    assert_raises(KonpeitoJSON::ParseError) { KonpeitoJSON.parse(bad, insitu: true) }
+    bad << "[]"
+    assert_equal "[]", bad
+  end
+
+  def test_parse_reuses_arena_across_sizes
+    small = '{"id": 1, "tags": ["a", "b"]}'
+    large = KonpeitoJSON.generate((1..5000).map { |i| {"k" => i, "s" => "v#{i}"} })
+    3.times do
+      assert_equal [1, %w[a b]], KonpeitoJSON.parse(small).values
+      assert_equal 5000, KonpeitoJSON.parse(large).size
+    end
+  end
+
+  def test_parse_flags
+    assert_equal [1, 2], KonpeitoJSON.parse("[1, 2,] // done",
+                                           KonpeitoJSON::ALLOW_TRAILING_COMMAS | KonpeitoJSON::ALLOW_COMMENTS)
+    assert KonpeitoJSON.parse("[Infinity]", KonpeitoJSON::ALLOW_INF_NAN).first.infinite?
+    assert_raises(ArgumentError) { KonpeitoJSON.parse("[1, 2,]") }
+    assert_equal({a: 1}, KonpeitoJSON.parse('{"a": 1}', nil, symbolize_names: true))
+  end
+
+  def test_parse_raw_numbers
+    json = "[12345678901234567890123, -7, 0.1, 18446744073709551616, 1e400]"
+    assert_raises(KonpeitoJSON::ParseError) { KonpeitoJSON.parse(json) } # 1e400 overflows a double
+    assert_in_delta 1.2345678901234568e22, KonpeitoJSON.parse("[12345678901234567890123]").first, 1e7
+
+    exact = KonpeitoJSON.parse(json, KonpeitoJSON::BIGNUM_AS_RAW)
+    assert_equal [12345678901234567890123, -7, 0.1, 18446744073709551616], exact[0, 4]
+    assert exact[4].infinite?
+
+    assert_equal exact[0, 4], KonpeitoJSON.parse(json, KonpeitoJSON::NUMBER_AS_RAW)[0, 4]
+  end
+
+  def test_open_with_raw_numbers
+    doc = KonpeitoJSON.open('{"ids": [1, 99999999999999999999, 2.5]}', KonpeitoJSON::NUMBER_AS_RAW)
+    assert_equal 99999999999999999999, doc.at("/ids/1")
+    assert_equal 2.5, doc["ids"][2]
+    assert_equal({"ids" => [1, 99999999999999999999, 2.5]}, doc.to_ruby)
+  end
+
+  def test_parse_error_position
+    error = assert_raises(KonpeitoJSON::ParseError) { KonpeitoJSON.parse("[1, x]") }
+    assert_kind_of ArgumentError, error
+    assert_equal 4, error.position
+    assert_match(/position 4/, error.message)
+  end
+
+  def test_parse_large_document
+    # Above the threshold the read runs without the GVL
+    json = KonpeitoJSON.generate((0...5000).map { |i| {"id" => i, "name" => "item#{i}"} })
+    assert_operator json.bytesize, :>, 32 * 1024
+    result = KonpeitoJSON.parse(json)
+    assert_equal 5000, result.size
+    assert_equal({"id" => 4999, "name" => "item4999"}, result.last)
+  end
+
+  def test_parse_many
+    jsons = (0...100).map { |i| %({"i": #{i}, "tags": ["a", "b"]}) }
+    result = KonpeitoJSON.parse_many(jsons, symbolize_names: true)
+    assert_equal 100, result.size
+    assert_equal({i: 42, tags: ["a", "b"]}, result[42])
+    assert_equal [], KonpeitoJSON.parse_many([])
+  end
+
+  def test_parse_many_threaded
+    big = KonpeitoJSON.generate((0...2000).map { |i| [i, i.to_s] })
+    jsons = Array.new(16) { |i| "[#{i}, #{big}]" }
+    result = KonpeitoJSON.parse_many(jsons, threads: 4)
+    assert_equal (0...16).to_a, result.map(&:first)
+    assert_equal [1999, "1999"], result[15][1].last
+  end
+
+  def test_parse_many_errors
+    error = assert_raises(KonpeitoJSON::ParseError) do
+      KonpeitoJSON.parse_many(["[1]", "{}", "[1, x]"])
+    end
+    assert_match(/document 2/, error.message)
+    assert_raises(TypeError) { KonpeitoJSON.parse_many(["[1]", 2]) }
+  end
+
   # === Generate Tests ===
 
   def test_generate_object
@@ -130,6 +266,38 @@ class KonpeitoJSONTest < Minitest::Test
     assert_equal 30, parsed["age"]
   end
 
+  def test_generate_preserves_key_order_and_stringifies_keys
+    obj = {"b" => 1, a: 2, 3 => "three", nil => nil}
+    assert_equal '{"b":1,"a":2,"3":"three","":null}', KonpeitoJSON.generate(obj)
+  end
+
+  def test_generate_large_hash
+    obj = (1..1000).to_h { |i| ["key#{i}", i] }
+    assert_equal obj, KonpeitoJSON.parse(KonpeitoJSON.generate(obj))
+  end
+
+  def test_generate_escapes
+    json = KonpeitoJSON.generate(["q\"uote", "back\\slash", "ctl\x01\n\t", "/", "日本語"])
+    assert_equal '["q\\"uote","back\\\\slash","ctl\\u0001\\n\\t","/","日本語"]', json
+    assert_equal Encoding::UTF_8, json.encoding
+  end
+
+  def test_generate_long_string_with_escapes
+    str = ("abcdefgh" * 1000 + "\"\x01\n") * 50
+    json = KonpeitoJSON.generate([str])
+    assert_equal 2 + 2 + str.bytesize + 50 * (1 + 5 + 1), json.bytesize
+    assert_equal [str], KonpeitoJSON.parse(json)
+  end
+
+  def test_generate_bignum
+    assert_equal "[1180591620717411303424]", KonpeitoJSON.generate([2**70])
+  end
+
+  def test_generate_invalid_values_raise
+    assert_raises(RuntimeError) { KonpeitoJSON.generate([Float::NAN]) }
+    assert_raises(RuntimeError) { KonpeitoJSON.generate(["\xff".b]) }
+  end
+
   def test_generate_unicode
     obj = {"text" => "日本語", "emoji" => "🎉"}
     json = KonpeitoJSON.generate(obj)
@@ -151,11 +319,34 @@ class KonpeitoJSONTest < Minitest::Test
     obj = {"a" => 1, "b" => [2, 3]}
     json = KonpeitoJSON.generate_pretty(obj, 2)
     assert_includes json, "\n"
-    assert_includes json, "    " # yyjson uses 4-space indent
+    assert_includes json, "    " # fixed 4-space indent
+    assert_equal "{\n    \"a\": 1,\n    \"b\": [\n        2,\n        3\n    ]\n}", json
     parsed = KonpeitoJSON.parse(json)
     assert_equal obj, parsed
   end
 
+  class GenPoint
+    def initialize(x, y, label = nil)
+      @x = x
+      @y = y
+      @label = label
+    end
+  end
+
+  def test_generate_as
+    assert_equal '{"x":1,"y":2.5,"label":"a\\"b"}', KonpeitoJSON.generate_as(GenPoint.new(1, 2.5, 'a"b'))
+    assert_equal '{"x":true,"y":null,"label":null}', KonpeitoJSON.generate_as(GenPoint.new(true, nil))
+    assert_equal "{}", KonpeitoJSON.generate_as(Object.new)
+  end
+
+  def test_generate_array_as
+    points = [GenPoint.new(1, 2), GenPoint.new(3, [4])]
+    assert_equal '[{"x":1,"y":2,"label":null},{"x":3,"y":[4],"label":null}]',
+                 KonpeitoJSON.generate_array_as(points)
+    assert_equal "[]", KonpeitoJSON.generate_array_as([])
+    assert_raises(TypeError) { KonpeitoJSON.generate_array_as(GenPoint.new(1, 2)) }
+  end
+
   # === Round-trip Tests ===
 
   def test_roundtrip_complex
@@ -178,6 +369,128 @@ class KonpeitoJSONTest < Minitest::Test
     assert_equal original, parsed
   end
 
+  # === Document Tests ===
+
+  DOC_JSON = '{"data": [{"id": 7, "name": "Alice", "tags": ["a", "b"]}, {"id": 8}], "a/b": 1, "meta": null}'
+
+  def test_open_at_pointer
+    doc = KonpeitoJSON.open(DOC_JSON)
+    assert_equal 7, doc.at("/data/0/id")
+    assert_equal ["a", "b"], doc.at("/data/0/tags")
+    assert_equal 1, doc.at("/a~1b")
+    assert_nil doc.at("/meta")
+    assert_nil doc.at("/missing/0")
+    assert_nil doc.at("/data/5")
+    assert_equal KonpeitoJSON.parse(DOC_JSON), doc.at("")
+  end
+
+  def test_open_views
+    doc = KonpeitoJSON.open(DOC_JSON)
+    data = doc["data"]
+    assert_kind_of KonpeitoJSON::View, data
+    assert data.array?
+    assert_equal 2, data.size
+    user = data[0]
+    assert user.object?
+    assert_equal ["id", "name", "tags"], user.keys
+    assert_equal "Alice", user[:name]
+    assert_equal 8, data[-1]["id"]
+    assert_nil data[2]
+    assert_equal "b", user.at("/tags/1")
+    assert_equal({"id" => 8}, data[1].to_ruby)
+  end
+
+  def test_open_root_and_to_ruby
+    doc = KonpeitoJSON.open(DOC_JSON, symbolize_names: true)
+    assert_kind_of KonpeitoJSON::View, doc.root
+    assert_equal KonpeitoJSON.parse(DOC_JSON, symbolize_names: true), doc.to_ruby
+    assert_equal 42, KonpeitoJSON.open("42").root
+  end
+
+  def test_open_view_outlives_document_reference
+    view = KonpeitoJSON.open(DOC_JSON)["data"][0]
+    GC.start
+    assert_equal "Alice", view["name"]
+  end
+
+  def test_open_invalid_json_raises
+    assert_raises(ArgumentError) { KonpeitoJSON.open("{invalid}") }
+  end
+
+  # === NDJSON Tests ===
+
+  def test_ndjson_roundtrip_file
+    records = (1..2000).map { |i| {"id" => i, "name" => "n" * (i % 97), "tags" => [i, nil]} }
+    Dir.mktmpdir do |dir|
+      path = File.join(dir, "records.ndjson")
+      assert_equal 2000, KonpeitoJSON.write_ndjson(path, records)
+      assert_equal 2000, File.readlines(path).size
+
+      parsed = []
+      KonpeitoJSON.each_ndjson(path) { |obj| parsed << obj }
+      assert_equal records, parsed
+    end
+  end
+
+  def test_each_ndjson_io_edge_cases
+    long = "y" * 600_000 # spans several read chunks
+    io = StringIO.new(%({"a":1}\r\n\n  \n{"long":"#{long}"}\n{"b":2}))
+    values = KonpeitoJSON.each_ndjson(io).to_a
+    assert_equal [{"a" => 1}, {"long" => long}, {"b" => 2}], values
+  end
+
+  def test_each_ndjson_options
+    src = %({"a":1}\n{"a":2}\n)
+    assert_equal ['{"a":1}', '{"a":2}'], KonpeitoJSON.each_ndjson(StringIO.new(src), raw: true).to_a
+    assert_equal [{a: 1}, {a: 2}], KonpeitoJSON.each_ndjson(StringIO.new(src), symbolize_names: true).to_a
+  end
+
+  def test_each_ndjson_reports_line
+    err = assert_raises(ArgumentError) do
+      KonpeitoJSON.each_ndjson(StringIO.new(%({"a":1}\n{bad}\n))) { |_| }
+    end
+    assert_match(/line 2/, err.message)
+  end
+
+  def test_ndjson_writer
+    io = StringIO.new
+    writer = KonpeitoJSON::NDJSONWriter.new(io)
+    writer << {"a" => 1}
+    assert_raises(RuntimeError) { writer << [Float::NAN] }
+    writer.write([2])
+    writer.close
+    assert_equal %({"a":1}\n[2]\n), io.string
+    assert_raises(IOError) { writer << 3 }
+  end
+
+  def test_ndjson_writer_sink_keeps_chunks
+    sink = Class.new do
+      attr_reader :chunks
+
+      def initialize = @chunks = []
+      def write(s) = @chunks << s
+    end.new
+    writer = KonpeitoJSON::NDJSONWriter.new(sink)
+    20_000.times { |i| writer << {"i" => i, "pad" => "x" * 16} }
+    writer.close
+
+    assert_operator sink.chunks.size, :>, 1
+    assert_equal sink.chunks.size, sink.chunks.map(&:object_id).uniq.size
+    lines = sink.chunks.join.lines
+    assert_equal 20_000, lines.size
+    assert_equal({"i" => 19_999, "pad" => "x" * 16}, KonpeitoJSON.parse(lines.last))
+  end
+
+  def test_ndjson_writer_close_when_write_raises
+    sink = Object.new
+    def sink.write(_) = raise(IOError, "disk full")
+    writer = KonpeitoJSON::NDJSONWriter.new(sink)
+    writer << 1
+    assert_raises(IOError) { writer.close }
+    assert_raises(IOError) { writer << 2 }
+    assert_nil writer.close
+  end
+
   # === Constants Tests ===
 
   def test_constants_defined
@@ -177,6 +177,137 @@ class CFuncTest < Minitest::Test
     refute_equal cfunc1, cfunc3
   end
 
+  def test_rbs_loader_parses_cfunc_buffer_params
+    rbs = <<~RBS
+      module Codec
+        %a{cfunc: "codec_checksum"}        def self.checksum: (ByteSlice) -> Integer
+
+        %a{cfunc: "codec_fill"}        def self.fill: (ByteBuffer, Integer) -> void
+
+        %a{cfunc: "vec_sum"}        def self.sum: (Slice[Float64]) -> Float
+
+        %a{cfunc: "vec_max"}        def self.max: (NativeArray[Integer]) -> Integer
+
+        %a{cfunc: "vec_count"}        def self.count: (Slice[Int64]) -> Integer
+      end
+    RBS
+
+    rbs_path = File.join(@tmp_dir, "codec.rbs")
+    File.write(rbs_path, rbs)
+
+    loader = Konpeito::TypeChecker::RBSLoader.new.load(rbs_paths: [rbs_path])
+
+    assert_equal [:ByteSlice], loader.cfunc_method(:Codec, :checksum, singleton: true).param_types
+    assert_equal [:ByteBuffer, :Integer], loader.cfunc_method(:Codec, :fill, singleton: true).param_types
+    assert_equal [:"Slice[Float64]"], loader.cfunc_method(:Codec, :sum, singleton: true).param_types
+    assert_equal [:"NativeArray[Int64]"], loader.cfunc_method(:Codec, :max, singleton: true).param_types
+    assert_equal [:"Slice[Int64]"], loader.cfunc_method(:Codec, :count, singleton: true).param_types
+  end
+
+  def test_cfunc_typed_buffer_params
+    cfunc_type = Konpeito::TypeChecker::Types::CFuncType
+    assert cfunc_type.buffer_param?(:"Slice[Float64]")
+    assert cfunc_type.buffer_param?(:"NativeArray[Int64]")
+    refute cfunc_type.buffer_param?(:"Array[Int64]")
+    assert_equal :Slice, cfunc_type.buffer_kind(:"Slice[Float64]")
+    assert_equal :ByteSlice, cfunc_type.buffer_kind(:ByteSlice)
+    assert_equal :Float64, cfunc_type.buffer_element_type(:"Slice[Float64]")
+    assert_nil cfunc_type.buffer_element_type(:ByteBuffer)
+
+    vec_sum = cfunc_type.new("vec_sum", [:"Slice[Float64]"], :Float, nogvl: true)
+    assert_equal [:ptr, :int64], vec_sum.llvm_param_types
+    assert_empty vec_sum.gvl_unsafe_types
+  end
+
+  def test_cfunc_buffer_params_expand_to_ptr_and_length
+    cfunc_type = Konpeito::TypeChecker::Types::CFuncType.new(
+      "codec_update",
+      [:Integer, :ByteSlice],
+      :Integer
+    )
+
+    assert_equal [:int64, :ptr, :int64], cfunc_type.llvm_param_types
+  end
+
+  def test_rbs_loader_parses_cfunc_ptr_len_return
+    rbs = <<~RBS
+      module Codec
+        %a{cfunc: "codec_encode" returns: "ptr_len"}        def self.encode: (ByteSlice) -> String
+
+        %a{cfunc: "codec_name"}        def self.name: () -> String
+      end
+    RBS
+
+    rbs_path = File.join(@tmp_dir, "codec_ret.rbs")
+    File.write(rbs_path, rbs)
+
+    loader = Konpeito::TypeChecker::RBSLoader.new.load(rbs_paths: [rbs_path])
+
+    encode = loader.cfunc_method(:Codec, :encode, singleton: true)
+    assert_equal "codec_encode", encode.c_func_name
+    assert_equal :ptr_len, encode.return_convention
+    assert encode.ptr_len_return?
+    assert_equal [:ptr, :int64, :ptr], encode.llvm_param_types
+    assert_equal "CFuncType(codec_encode: (ByteSlice) -> String(ptr, len))", encode.to_s
+
+    name = loader.cfunc_method(:Codec, :name, singleton: true)
+    assert_equal :cstr, name.return_convention
+    refute name.ptr_len_return?
+  end
+
+  def test_cfunc_byte_slice_return_uses_ptr_len
+    cfunc_type = Konpeito::TypeChecker::Types::CFuncType.new(
+      "konpeito_shell_mmap_file",
+      [:String],
+      :ByteSlice
+    )
+
+    assert cfunc_type.ptr_len_return?
+    assert_equal [:ptr, :ptr], cfunc_type.llvm_param_types
+    assert_equal :ptr, cfunc_type.llvm_return_type
+  end
+
+  def test_rbs_loader_parses_nogvl_annotation
+    rbs = <<~RBS
+      module Kernels
+        %a{cfunc: "kernel_blur"}        %a{nogvl}        def self.blur: (Slice[Float64], Integer) -> void
+
+        %a{cfunc: "kernel_pack" returns: "ptr_len"}        %a{nogvl}        def self.pack: (ByteSlice) -> String
+
+        %a{cfunc: "kernel_sum"}        def self.sum: (Slice[Float64]) -> Float
+      end
+    RBS
+
+    rbs_path = File.join(@tmp_dir, "kernels.rbs")
+    File.write(rbs_path, rbs)
+
+    loader = Konpeito::TypeChecker::RBSLoader.new.load(rbs_paths: [rbs_path])
+
+    blur = loader.cfunc_method(:Kernels, :blur, singleton: true)
+    assert blur.nogvl
+    assert_empty blur.gvl_unsafe_types
+
+    assert loader.cfunc_method(:Kernels, :pack, singleton: true).nogvl
+    refute loader.cfunc_method(:Kernels, :sum, singleton: true).nogvl
+  end
+
+  def test_nogvl_rejects_ruby_object_params
+    rbs = <<~RBS
+      module Kernels
+        %a{cfunc: "kernel_hash"}        %a{nogvl}        def self.hash_str: (String) -> Integer
+      end
+    RBS
+
+    rbs_path = File.join(@tmp_dir, "kernels_bad.rbs")
+    File.write(rbs_path, rbs)
+
+    error = assert_raises(Konpeito::Error) do
+      Konpeito::TypeChecker::RBSLoader.new.load(rbs_paths: [rbs_path])
+    end
+    assert_match(/%a\{nogvl\} Kernels\.hash_str/, error.message)
+    assert_match(/String is not GVL-safe/, error.message)
+  end
+
   # === @ffi annotation tests ===
 
   def test_ffi_annotation_parsing